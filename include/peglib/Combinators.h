@@ -4,6 +4,8 @@
 #pragma once
 #include "peglib/ParserFwd.h"
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -48,7 +50,31 @@ struct SequenceExpr : ParsingExpr<Context, SequenceExpr<Context, Children...>>
         std::apply([&refs](const auto&... c) { (c.collect_rule_refs(refs), ...); }, m_children);
     }
 
+    // The deepest child bounds the sequence.
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        return std::apply(
+            [&gen](const auto&... c) { return std::max({c.generate_cost(gen)...}); }, m_children);
+    }
+
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        return generateSeq<0>(gen);
+    }
+
 protected:
+    template<size_t Index>
+    bool generateSeq(Generator<typename Context::value_type>& gen) const
+    {
+        if constexpr (Index < sizeof...(Children)) {
+            if constexpr (Index > 0) {
+                gen.separate();
+            }
+            return std::get<Index>(m_children).generate(gen) && generateSeq<Index + 1>(gen);
+        }
+        return true;
+    }
+
     template<size_t Index>
     bool parseSeq(Context& context, ParseTreeNodePtr& node) const
     {
@@ -69,9 +95,11 @@ protected:
     std::tuple<Children...> m_children;
 };
 
-// Tries each alternative in order; first success wins. Cut-committed failure
-// throws peg::ParseError. The winning branch index is stamped on the node
-// (alt_winner) so the typed fold can dispatch on the winning branch's type.
+// Tries each alternative in order; first success wins. A failure after a cut
+// commits the whole parse to failing (Context::commit_failure); so does a
+// committed failure from inside any alternative. The winning branch index is
+// stamped on the node (alt_winner) so the typed fold can dispatch on the
+// winning branch's type.
 template<typename Context, typename... Children>
 struct AlternationExpr : ParsingExpr<Context, AlternationExpr<Context, Children...>>
 {
@@ -93,7 +121,36 @@ struct AlternationExpr : ParsingExpr<Context, AlternationExpr<Context, Children.
         std::apply([&refs](const auto&... c) { (c.collect_rule_refs(refs), ...); }, m_children);
     }
 
+    // The shallowest branch bounds the choice.
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        return std::apply(
+            [&gen](const auto&... c) { return std::min({c.generate_cost(gen)...}); }, m_children);
+    }
+
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        const std::array<std::size_t, sizeof...(Children)> costs = std::apply(
+            [&gen](const auto&... c) {
+                return std::array<std::size_t, sizeof...(Children)>{c.generate_cost(gen)...};
+            },
+            m_children);
+        return generateAlt<0>(gen, gen.choose(costs));
+    }
+
 protected:
+    template<size_t Index>
+    bool generateAlt(Generator<typename Context::value_type>& gen, std::size_t pick) const
+    {
+        if constexpr (Index < sizeof...(Children)) {
+            if (Index == pick) {
+                return std::get<Index>(m_children).generate(gen);
+            }
+            return generateAlt<Index + 1>(gen, pick);
+        }
+        return false; // npos: no branch can be generated
+    }
+
     template<size_t Index>
     ParseResult parseAlt(Context& context) const
     {
@@ -104,8 +161,9 @@ protected:
                     result.tree->alt_winner = Index;
                 return result;
             }
-            if (context.cut()) {
-                throw ParseError{context.furthest_failure_pos(), context.expected()};
+            if (context.cut() || context.committed_failure()) {
+                context.commit_failure();
+                return {false, nullptr};
             }
             return parseAlt<Index + 1>(context);
         }
@@ -116,10 +174,11 @@ protected:
 
 // Seed-grow loop behind every Repetition subclass.
 //
-// Cut escalation is asymmetric: unbounded (* +, max_rep < 0) rethrows a
-// cut-committed child failure as peg::ParseError; bounded (? n*e) stops on
-// failure and returns the iterations matched so far, since a bounded
-// repetition legitimately admits fewer matches.
+// Cut escalation is asymmetric: unbounded (* +, max_rep < 0) escalates a
+// cut-committed child failure to a committed failure of the whole parse;
+// bounded (? n*e) stops on failure and returns the iterations matched so
+// far, since a bounded repetition legitimately admits fewer matches. A
+// committed failure from deeper inside the child fails either kind.
 template<typename Context, typename ChildOp>
     requires std::invocable<ChildOp&, Context&>
 typename Context::ParseResult
@@ -142,6 +201,9 @@ repeat_parse_impl(Context& context, ChildOp parse_child, std::size_t min_rep, st
         auto startState = context.state();
         context.cut(false);
         auto result = parse_child(context);
+        if (!result.success && context.committed_failure()) {
+            return {false, nullptr};
+        }
         if (result.success) {
             loopCount++;
             lastSuccessState = context.state();
@@ -169,7 +231,8 @@ repeat_parse_impl(Context& context, ChildOp parse_child, std::size_t min_rep, st
     }
     if (max_rep < 0) {
         if (exited_via_failure && context.cut()) {
-            throw ParseError{context.furthest_failure_pos(), context.expected()};
+            context.commit_failure();
+            return {false, nullptr};
         }
     }
     node->end_offset = context.mark();
@@ -210,6 +273,41 @@ struct Repetition : ParsingExpr<Context, Self>
         m_child.collect_rule_refs(refs);
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        return min_rep == 0 ? 0 : m_child.generate_cost(gen);
+    }
+
+    // An unbounded repetition whose child reaches rules is structural (see
+    // Generator::repetitions); an iteration that emits nothing ends it.
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        using Gen = Generator<typename Context::value_type>;
+        const bool structural = max_rep < 0 && m_child.generate_cost(gen) != 0;
+        if (structural) {
+            gen.enter_repetition();
+        }
+        const std::size_t n = gen.repetitions(min_rep, max_rep, structural);
+        bool ok = true;
+        for (std::size_t i = 0; ok; ++i) {
+            if (n == Gen::unbounded ? (i >= min_rep && gen.closing()) : i >= n) {
+                break;
+            }
+            const std::size_t before = gen.output().size();
+            if (i > 0) {
+                gen.separate();
+            }
+            ok = m_child.generate(gen);
+            if (ok && i >= min_rep && gen.output().size() == before) {
+                break;
+            }
+        }
+        if (structural) {
+            gen.leave_repetition();
+        }
+        return ok;
+    }
+
 protected:
     Child m_child;
     std::size_t min_rep;
@@ -251,7 +349,7 @@ struct OptionalExpr : Repetition<Context, Child, OptionalExpr<Context, Child>>
 
 // Shared body for lookahead (&) and negation (!) predicates. The operand is
 // executed speculatively and its consumed input rewound; the result tree is
-// always discarded.
+// always discarded. A committed failure is never negated into a match.
 template<typename Context, typename ChildOp>
     requires std::invocable<ChildOp&, Context&>
 typename Context::ParseResult
@@ -260,6 +358,9 @@ predicate_parse_impl(Context& context, ChildOp parse_child, bool negate)
     auto initState = context.state();
     auto result = parse_child(context);
     context.state(initState);
+    if (context.committed_failure()) {
+        return {false, nullptr};
+    }
     return {negate ? !result.success : result.success, nullptr};
 }
 
@@ -278,6 +379,13 @@ struct NotExpr : ParsingExpr<Context, NotExpr<Context, Child>>
         m_child.collect_rule_refs(refs);
     }
 
+    // Lookahead consumes nothing, so it generates nothing.
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>&) const override { return true; }
+
 protected:
     Child m_child;
 };
@@ -298,12 +406,18 @@ struct AndExpr : ParsingExpr<Context, AndExpr<Context, Child>>
         m_child.collect_rule_refs(refs);
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>&) const override { return true; }
+
 protected:
     Child m_child;
 };
 
 // Commits the current alternative/repetition scope. Subsequent failure in the
-// same scope throws peg::ParseError.
+// same scope fails the whole parse (a committed failure).
 template<typename Context>
 struct CutExpr : ParsingExpr<Context, CutExpr<Context>>
 {
@@ -312,6 +426,12 @@ struct CutExpr : ParsingExpr<Context, CutExpr<Context>>
         context.cut(true);
         return {true, nullptr};
     }
+
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>&) const override { return true; }
 };
 
 // Disables auto-skip for a sub-expression's subtree. Save/restore of
@@ -338,6 +458,21 @@ struct LexemeExpr : ParsingExpr<Context, LexemeExpr<Context, Child>>
         m_child.collect_rule_refs(refs);
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        return m_child.generate_cost(gen);
+    }
+
+    // No separators inside a lexeme, as no skipping.
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        const bool prev = gen.lexeme();
+        gen.lexeme(true);
+        const bool ok = m_child.generate(gen);
+        gen.lexeme(prev);
+        return ok;
+    }
+
 protected:
     Child m_child;
 };
@@ -7,12 +7,18 @@
 //               type for recursive ASTs; shared_ptr<T> for polymorphic ASTs.
 //   - Source  : input storage strategy. Erased behind InputSourceBase;
 //               SpanSource (contiguous, zero-virtual-call hot path) or
-//               FileSourceSource (paged, cut-evictable). Selected at
+//               FileSourceSource / PagedFileSourceSource (paged,
+//               cut-evictable) or MmapSourceSource
+//               (mapped file, zero-virtual-call hot path). Selected at
 //               construction, invisible to the template signature.
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <map>
@@ -21,14 +27,19 @@
 #include <set>
 #include <span>
 #include <stack>
+#include <stdexcept>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <unordered_set>
 #include <variant>
 #include <vector>
 
 #include "InputSource.h"
+#include "MemoTable.h"
 #include "ParseError.h"
+#include "Profiler.h"
 namespace peg
 {
 
@@ -41,6 +52,70 @@ struct Span
     std::size_t end{};
 };
 
+// Expected-set bookkeeping mode (see Context::error_tracking).
+enum class ErrorTracking
+{
+    Full,     // record the furthest failure + expected set (default)
+    Off,      // no bookkeeping: a failed parse reports no diagnostic
+    Deferred, // parse untracked; on failure Grammar re-parses with Full
+};
+
+// Memory held by one Context (see Context::memory_stats). Byte figures are
+// estimates: element sizes plus memo blocks and slot capacity, without
+// allocator overhead. Capacity kept by Context::clear() for the next parse
+// (spare arena nodes, spare memo blocks) counts toward the bytes.
+struct MemoryStats
+{
+    // Parse-tree arena. Nodes reachable from the tree passed to
+    // memory_stats are `tree_nodes`; the rest were built by failed branches
+    // (or belong to no tree at all, when none was passed). `spare_nodes`
+    // are kept from an earlier parse for reuse.
+    std::size_t arena_nodes = 0;
+    std::size_t spare_nodes = 0;
+    std::size_t arena_bytes = 0; // all nodes plus their children vectors
+    std::size_t tree_nodes = 0;
+    std::size_t garbage_nodes = 0;
+
+    // Packrat memo: positions with entries, entries (one per rule and
+    // position), position blocks in use and kept for reuse
+    // (MemoTable::block_size positions each), and the entry capacity of
+    // every slot in those blocks.
+    std::size_t memo_positions = 0;
+    std::size_t memo_entries = 0;
+    std::size_t memo_blocks = 0;
+    std::size_t memo_spare_blocks = 0;
+    std::size_t memo_slot_capacity = 0;
+    std::size_t memo_bytes = 0;
+
+    // Left-recursion heads currently growing (empty between parses).
+    std::size_t growing_heads = 0;
+
+    std::size_t diagnostics = 0;
+
+    // Pages the input source holds in memory: FileSource's buffers,
+    // PagedFileSource's cache. Zero for in-memory and mapped input.
+    std::size_t resident_pages = 0;
+
+    [[nodiscard]] std::size_t bytes() const noexcept { return arena_bytes + memo_bytes; }
+};
+
+// Resource limits for parsing untrusted input (see Context::limits). Each
+// limit is off at its default.
+struct ParseLimits
+{
+    // Rule applications, memo hits included.
+    std::uint64_t max_steps = 0;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // Arena plus memo, in bytes: an estimate from the node and memo entry
+    // counts (MemoryStats::bytes measures the same two by walking them).
+    std::size_t max_memory = 0;
+    // Nested rule applications: bounds the recursion, and with it the C++
+    // stack a deeply nested input can take.
+    std::size_t max_depth = 0;
+    // Set (to true) from any thread to stop the parse.
+    const std::atomic<bool>* cancel = nullptr;
+};
+
 namespace parsers
 {
 template<typename Context>
@@ -64,10 +139,17 @@ struct Context
     // (1) From a contiguous range: stores a non-owning SpanSource pointing
     //     into `t`. Caller must keep the input alive for the Context's
     //     lifetime. **Passing a temporary here dangles silently.** For a
-    //     self-contained copy, use Grammar::parse_string.
+    //     self-contained copy, use Grammar::parse_string. rebind() points
+    //     the Context at another range for the next parse.
     //
-    // (2) From a FileSource rvalue: takes ownership (moved into a
-    //     FileSourceSource adapter). No lifetime obligation on the caller.
+    // (2) From a FileSource or PagedFileSource rvalue: takes ownership
+    //     (moved into its adapter). No lifetime obligation on the caller.
+    //
+    // (3) From a PushSource rvalue: takes ownership; more input is appended
+    //     later through feed() / close_input() (see Grammar::parse_async).
+    //
+    // (4) From an MmapSource rvalue: takes ownership of the mapping, which is
+    //     then indexed directly like a contiguous range.
     // -----------------------------------------------------------------------
     template<typename Range>
     Context(const Range& t)
@@ -82,6 +164,21 @@ struct Context
           m_fast_data{nullptr}, m_input_size{m_input->size()}
     {}
 
+    Context(PagedFileSource<CharT>&& ps)
+        : m_input{std::make_unique<PagedFileSourceSource<CharT>>(std::move(ps))},
+          m_fast_data{nullptr}, m_input_size{m_input->size()}
+    {}
+
+    Context(PushSource<CharT>&& ps)
+        : m_input{std::make_unique<PushSource<CharT>>(std::move(ps))},
+          m_fast_data{m_input->contiguous_data()}, m_input_size{m_input->size()}
+    {}
+
+    Context(MmapSource<CharT>&& ms)
+        : m_input{std::make_unique<MmapSourceSource<CharT>>(std::move(ms))},
+          m_fast_data{m_input->contiguous_data()}, m_input_size{m_input->size()}
+    {}
+
     // Move is allowed (e.g. from from_file); copy is not — copying mid-parse
     // would duplicate memo entries keyed by raw NonTerminal* and silently
     // corrupt furthest-error state.
@@ -148,6 +245,11 @@ struct Context
         // position, not derivable from the tree).
         std::size_t m_last_pos = 0;
         ParseResult m_cached_result;
+        // The evaluation that produced this answer reached the end of the
+        // buffered input (see end_hits()). Only meaningful for a PushSource
+        // that is still open: such an answer may change once more input
+        // arrives, so prepare_resume() drops it instead of replaying it.
+        bool m_touched_end = false;
     };
 
     // Transient left-recursion control state, one per NonTerminal currently on
@@ -178,38 +280,283 @@ struct Context
     std::size_t input_size() const noexcept { return m_input_size; }
     State state() { return State{m_position}; }
     void state(const State& state) { m_position = state.m_pos; }
-    bool ended() const noexcept { return m_position >= m_input_size; }
+    bool ended() const noexcept
+    {
+        if (m_position < m_input_size) {
+            return false;
+        }
+        ++m_end_hits;
+        return true;
+    }
     std::size_t mark() const noexcept { return m_position; }
 
-    // Per-character access. Uses the contiguous cache when available (zero
-    // virtual dispatch); falls back to the virtual at() for paged sources.
-    value_type current() const
+    // ended() for an arbitrary offset. Matchers that scan ahead should test
+    // their bound through this (rather than comparing against input_size()
+    // directly) so a resumable parse knows the match depended on the end of
+    // the buffered input.
+    bool ended_at(std::size_t offset) const noexcept
     {
-        assert(m_position < m_input_size && "current() past end of input");
-        if (m_fast_data) {
-            return m_fast_data[m_position];
+        if (offset < m_input_size) {
+            return false;
         }
-        return m_input->at(m_position);
+        ++m_end_hits;
+        return true;
     }
+
+    // Number of times the parse has observed the end of the buffered input.
+    // NonTerminal compares it across a first-time evaluation to stamp
+    // RuleState::m_touched_end; nothing else reads it.
+    [[nodiscard]] std::size_t end_hits() const noexcept { return m_end_hits; }
+    void note_end_reached() const noexcept { ++m_end_hits; }
+
+    // Per-character access. Uses the contiguous cache when available (zero
+    // virtual dispatch); for paged sources, indexes the source's current page
+    // window, and only a page crossing goes through the virtual at().
+    value_type current() const { return at(m_position); }
     value_type at(std::size_t offset) const
     {
         assert(offset < m_input_size && "at() past end of input");
         if (m_fast_data) {
             return m_fast_data[offset];
         }
+        const InputWindow<CharT>& w = *m_window;
+        if (w.contains(offset)) {
+            return w.data[offset - w.begin];
+        }
         return m_input->at(offset);
     }
 
     [[nodiscard]] InputSourceBase<CharT>& input() const noexcept { return *m_input; }
 
-    // Allocate a fresh ParseTreeNode owned by this Context's arena. The node
-    // is value-initialized; the caller fills in its fields and the node lives
-    // until the Context is destroyed (no per-node free — a monotonic pool).
-    // On a failed branch the node simply becomes unreachable garbage in the
-    // arena, which is correctness-neutral (the standard arena high-water-mark
-    // tradeoff) and avoids the alloc/free churn that the make_shared model
-    // paid on every speculative combinator node.
-    ParseTreeNode* make_node() { return &m_node_arena.emplace_back(); }
+    // -----------------------------------------------------------------------
+    // Bulk access, for matchers and typed actions that want memchr / strtod
+    // style routines instead of one at() per element.
+    //
+    // chunk(pos): the longest run starting at `pos` that is contiguous in
+    // memory — the rest of the input for contiguous sources, the rest of the
+    // page holding `pos` for paged ones. Empty at or past the end (and for a
+    // custom source that publishes neither contiguous data nor a window).
+    //
+    // view(span): the text of `span`. Zero-copy whenever the span is
+    // contiguous in memory (always for contiguous sources; within one page
+    // for paged ones); otherwise copied once into a per-Context scratch
+    // buffer.
+    //
+    // Lifetime: over a contiguous source the result lives as long as the
+    // input. Over a paged source it is valid until the next input access
+    // through this Context (a page fault may refill the buffer it points
+    // into) or the next view() (which may reuse the scratch buffer).
+    // -----------------------------------------------------------------------
+    [[nodiscard]] std::span<const CharT> chunk(std::size_t pos) const
+    {
+        if (pos >= m_input_size) {
+            return {};
+        }
+        if (m_fast_data) {
+            return {m_fast_data + pos, m_input_size - pos};
+        }
+        const InputWindow<CharT>& w = *m_window;
+        if (!w.contains(pos)) {
+            (void)m_input->at(pos); // fault the page in; moves the window
+            if (!w.contains(pos)) {
+                return {};
+            }
+        }
+        return {w.data + (pos - w.begin), w.end - pos};
+    }
+
+    [[nodiscard]] std::basic_string_view<CharT> view(Span sp) const
+        requires std::is_integral_v<CharT>
+    {
+        assert(sp.start <= sp.end && sp.end <= m_input_size && "view() span out of range");
+        const std::size_t n = sp.end - sp.start;
+        if (n == 0) {
+            return {};
+        }
+        const std::span<const CharT> run = chunk(sp.start);
+        if (run.size() >= n) {
+            return {run.data(), n};
+        }
+        m_view_scratch.resize(n);
+        m_input->read(sp.start, n, m_view_scratch.data());
+        return {m_view_scratch.data(), n};
+    }
+
+    // -----------------------------------------------------------------------
+    // Push input (Context constructed from a PushSource). feed() appends and
+    // re-publishes the contiguous pointer (the buffer may have moved);
+    // close_input() marks end-of-stream. Both throw std::logic_error on any
+    // other source.
+    // -----------------------------------------------------------------------
+    void feed(std::span<const CharT> data)
+    {
+        push_source().feed(data);
+        m_fast_data = m_input->contiguous_data();
+        m_input_size = m_input->size();
+    }
+
+    void close_input() { push_source().close(); }
+
+    [[nodiscard]] bool input_open() const noexcept { return m_input->input_open(); }
+
+    // Rewind for another attempt after feed(). Memo entries whose evaluation
+    // reached the old end of input are dropped (their answer may change now
+    // that more input exists); every other entry is kept and replays on the
+    // re-drive, so only the frontier is actually re-parsed. The transient
+    // state — cut stack, LR frames, growing heads — is empty between attempts
+    // and is rebuilt by the re-drive. A furthest failure recorded at or past
+    // the old end is stale and cleared, as are recovery diagnostics recorded
+    // by dropped entries.
+    void prepare_resume()
+    {
+        m_mem.for_each([this](std::size_t, auto& rules) {
+            m_memo_entries -=
+                rules.erase_if([](const auto& item) { return item.second.m_touched_end; });
+        });
+        m_growing_head.clear();
+        // Defensive: an exception from user code (a matcher) unwinds past
+        // lr_pop, so the previous attempt may have left stale frames behind.
+        m_lr_stack = nullptr;
+        m_committed_failure = false;
+        if (m_has_error && m_furthest_failure_pos >= m_attempt_size) {
+            clear_error();
+        }
+        for (auto i = m_provisional_diagnostics.rbegin(); i != m_provisional_diagnostics.rend();
+             ++i) {
+            m_diagnostics.erase(m_diagnostics.begin() + static_cast<std::ptrdiff_t>(*i));
+        }
+        m_provisional_diagnostics.clear();
+        m_attempt_size = m_input_size;
+        m_position = 0;
+    }
+
+    // -----------------------------------------------------------------------
+    // Reuse. clear() returns the Context to its state before the first
+    // parse over the same input: position, memo, cut stack, LR state, error
+    // state, diagnostics, limit counters and the arena are reset, but the
+    // memory behind them is kept — arena nodes (and their children
+    // vectors), memo blocks and slots, the diagnostics vector. Configuration
+    // stays: error tracking mode, profiler, limits. rebind() does the same
+    // over another contiguous range, which must outlive the parse as in (1).
+    // A Context kept across parses of similar-sized inputs therefore
+    // allocates nothing once warm (Grammar::parse_view). Every tree node
+    // from an earlier parse is reused: a parse_tree() result dies with
+    // clear() or rebind(). rebind() throws std::logic_error on a Context
+    // over a file, mapping or push source.
+    // -----------------------------------------------------------------------
+    void clear()
+    {
+        m_position = 0;
+        m_last_cut = 0;
+        m_end_hits = 0;
+        m_attempt_size = 0;
+        m_arena_used = 0;
+        m_mem.clear();
+        m_memo_entries = 0;
+        while (!m_cut.empty()) { // empty unless a parse threw
+            m_cut.pop();
+        }
+        m_committed_failure = false;
+        m_lr_stack = nullptr;
+        m_growing_head.clear();
+        clear_error();
+        m_diagnostics.clear();
+        m_provisional_diagnostics.clear();
+        m_limit_hit = LimitKind::None;
+        m_limit_pos = 0;
+        m_steps = 0;
+        m_depth = 0;
+    }
+
+    template<typename Range>
+    void rebind(const Range& t)
+    {
+        auto* span = dynamic_cast<SpanSource<CharT>*>(m_input.get());
+        if (span == nullptr) {
+            throw std::logic_error{"Context::rebind: input is not an in-memory range"};
+        }
+        span->rebind(std::span<const CharT>(t).data(), std::span<const CharT>(t).size());
+        m_fast_data = m_input->contiguous_data();
+        m_input_size = m_input->size();
+        clear();
+    }
+
+    // Hand out a ParseTreeNode owned by this Context's arena. The node is
+    // value-initialized; the caller fills in its fields and the node lives
+    // until the Context is destroyed or cleared (no per-node free — a
+    // monotonic pool). On a failed branch the node simply becomes
+    // unreachable garbage in the arena, which is correctness-neutral (the
+    // standard arena high-water-mark tradeoff) and avoids the alloc/free
+    // churn that the make_shared model paid on every speculative combinator
+    // node. After clear() the arena hands its nodes out again, each with its
+    // children vector emptied but its capacity kept.
+    ParseTreeNode* make_node()
+    {
+        if (m_arena_used == m_node_arena.size()) [[likely]] {
+            ++m_arena_used;
+            return &m_node_arena.emplace_back();
+        }
+        ParseTreeNode& node = m_node_arena[m_arena_used++];
+        std::vector<ParseTreeNode*> children = std::move(node.children);
+        children.clear();
+        node = ParseTreeNode{};
+        node.children = std::move(children);
+        return &node;
+    }
+
+    // Size counters for benchmarks and tests: nodes handed out by the arena
+    // in this parse (reachable or not), and packrat memo entries currently
+    // held (entries dropped by cut eviction are not counted).
+    [[nodiscard]] std::size_t node_count() const noexcept { return m_arena_used; }
+    [[nodiscard]] std::size_t memo_entry_count() const noexcept { return m_memo_entries; }
+
+    // What this Context holds, for logging per parse and sizing memory
+    // limits. `tree` (the result of parse_tree, optional) splits the arena
+    // into reachable and garbage nodes. Walks the arena, the memo and the
+    // tree: call it after a parse, not per rule.
+    [[nodiscard]] MemoryStats memory_stats(const ParseTreeNode* tree = nullptr) const
+    {
+        MemoryStats stats;
+        stats.arena_nodes = m_arena_used;
+        stats.spare_nodes = m_node_arena.size() - m_arena_used;
+        stats.arena_bytes = m_node_arena.size() * sizeof(ParseTreeNode);
+        for (const ParseTreeNode& node : m_node_arena) {
+            stats.arena_bytes += node.children.capacity() * sizeof(ParseTreeNode*);
+        }
+        if (tree != nullptr) {
+            // Memo hits share subtrees, so the tree is a DAG: count each
+            // node once.
+            std::unordered_set<const ParseTreeNode*> seen{tree};
+            std::vector<const ParseTreeNode*> work{tree};
+            while (!work.empty()) {
+                const ParseTreeNode* node = work.back();
+                work.pop_back();
+                for (const ParseTreeNode* child : node->children) {
+                    if (child != nullptr && seen.insert(child).second) {
+                        work.push_back(child);
+                    }
+                }
+            }
+            stats.tree_nodes = seen.size();
+        }
+        stats.garbage_nodes = stats.arena_nodes - stats.tree_nodes;
+
+        constexpr std::size_t entry = sizeof(typename Memo::Slot::value_type);
+        stats.memo_blocks = m_mem.block_count();
+        stats.memo_spare_blocks = m_mem.spare_block_count();
+        stats.memo_slot_capacity = m_mem.entry_capacity();
+        stats.memo_bytes = (stats.memo_blocks + stats.memo_spare_blocks) * Memo::block_bytes +
+                           stats.memo_slot_capacity * entry;
+        m_mem.for_each([&stats](std::size_t, const auto& rules) {
+            ++stats.memo_positions;
+            stats.memo_entries += rules.size();
+        });
+
+        stats.growing_heads = m_growing_head.size();
+        stats.diagnostics = m_diagnostics.size();
+        stats.resident_pages = m_input->resident_pages();
+        return stats;
+    }
 
     void next() noexcept
     {
@@ -229,11 +576,10 @@ struct Context
 
     std::tuple<bool, RuleState> rule_state(const NonTerminalType* rule, std::size_t pos)
     {
-        // try_emplace value-initializes an empty inner map on a miss without
-        // naming its (now unordered_map) type, so the body stays agnostic to
-        // the inner container choice.
-        auto [iter_records, ins] = m_mem.try_emplace(pos);
-        auto [iter, ok] = iter_records->second.emplace(rule, RuleState{});
+        // try_emplace: a hit allocates nothing (emplace would build the node
+        // before finding the key).
+        auto [iter, ok] = m_mem.slot(pos).try_emplace(rule);
+        m_memo_entries += ok ? 1 : 0;
         return std::tuple<bool, RuleState>{ok, iter->second};
     }
 
@@ -241,12 +587,12 @@ struct Context
                            std::size_t start_pos,
                            const RuleState& rule_state)
     {
-        auto memos = m_mem.find(start_pos);
-        if (memos == m_mem.end()) {
+        auto* memos = m_mem.find(start_pos);
+        if (memos == nullptr) {
             return false;
         }
-        auto memo = memos->second.find(rule);
-        if (memo == memos->second.end()) {
+        auto memo = memos->find(rule);
+        if (memo == memos->end()) {
             return false;
         }
         memo->second = rule_state;
@@ -258,12 +604,12 @@ struct Context
     // the freshly-grown seed. Returns a default state if no entry exists.
     RuleState memo_get(const NonTerminalType* rule, std::size_t pos) const
     {
-        auto memos = m_mem.find(pos);
-        if (memos == m_mem.end()) {
+        const auto* memos = m_mem.find(pos);
+        if (memos == nullptr) {
             return RuleState{};
         }
-        auto it = memos->second.find(rule);
-        if (it == memos->second.end()) {
+        auto it = memos->find(rule);
+        if (it == memos->end()) {
             return RuleState{};
         }
         return it->second;
@@ -303,16 +649,26 @@ struct Context
 
     [[nodiscard]] const NonTerminalType* growing_head(std::size_t pos) const noexcept
     {
-        auto it = m_growing_head.find(pos);
+        auto it = find_growing_head(pos);
         return it == m_growing_head.end() ? nullptr : it->second;
     }
 
     void set_growing_head(std::size_t pos, const NonTerminalType* rule)
     {
-        m_growing_head[pos] = rule;
+        if (auto it = find_growing_head(pos); it != m_growing_head.end()) {
+            it->second = rule;
+        } else {
+            m_growing_head.emplace_back(pos, rule);
+        }
     }
 
-    void clear_growing_head(std::size_t pos) noexcept { m_growing_head.erase(pos); }
+    void clear_growing_head(std::size_t pos) noexcept
+    {
+        if (auto it = find_growing_head(pos); it != m_growing_head.end()) {
+            *it = m_growing_head.back();
+            m_growing_head.pop_back();
+        }
+    }
 
     // Clear every memo entry at `pos` except `keep` AND except any rule
     // currently on the LR stack at `pos`. Called by a head's growth loop at
@@ -322,16 +678,17 @@ struct Context
     // mid-evaluation up the call chain must NOT have its memo dropped.
     void clear_siblings_at(std::size_t pos, const NonTerminalType* keep)
     {
-        auto memos = m_mem.find(pos);
-        if (memos == m_mem.end()) {
+        auto* memos = m_mem.find(pos);
+        if (memos == nullptr) {
             return;
         }
-        for (auto it = memos->second.begin(); it != memos->second.end();) {
+        for (auto it = memos->begin(); it != memos->end();) {
             const NonTerminalType* rule = it->first;
             if (rule == keep || lr_in_progress(rule, pos)) {
                 ++it;
             } else {
-                it = memos->second.erase(it);
+                it = memos->erase(it);
+                --m_memo_entries;
             }
         }
     }
@@ -356,16 +713,24 @@ struct Context
 
     bool cut() { return m_cut.empty() ? false : m_cut.top().cut; }
 
+    // Committed failure: a cut scope failed, so the parse as a whole has
+    // failed. Sticky until the next Grammar entry point starts a parse; every
+    // combinator that would otherwise recover from a failure (Alternation,
+    // repetition, predicates, NonTerminal recovery) checks it and propagates
+    // the failure instead. This replaces unwinding by exception: the
+    // failure travels back through ordinary ParseResult returns, and the
+    // diagnostic is the furthest failure recorded so far, as before.
+    void commit_failure() noexcept { m_committed_failure = true; }
+    [[nodiscard]] bool committed_failure() const noexcept { return m_committed_failure; }
+    void clear_committed_failure() noexcept { m_committed_failure = false; }
+
     void init_cut() { m_cut.emplace(mark(), false); }
 
     void remove_cut()
     {
         if (cut()) {
             m_last_cut = m_cut.top().pos;
-            std::erase_if(m_mem, [this](const auto& item) {
-                const auto& [pos, record] = item;
-                return pos < m_last_cut;
-            });
+            m_memo_entries -= m_mem.release_before(m_last_cut);
             m_input->release_before(m_last_cut);
         }
         m_cut.pop();
@@ -405,19 +770,187 @@ struct Context
 
     using expected_set = ExpectedSet;
 
+    // Most inputs parse cleanly, and for them every furthest-failure compare
+    // and expected-item build is wasted. Off skips it all (record_failure is
+    // a single branch; NonTerminal does not even copy its name). Deferred
+    // parses the same way, and only when the parse fails does Grammar run it
+    // again tracked — so a failing input gets exactly the Diagnostic Full
+    // would have produced, at the cost of parsing it twice.
+    void error_tracking(ErrorTracking mode) noexcept
+    {
+        m_error_tracking = mode;
+        m_track_errors = mode == ErrorTracking::Full;
+    }
+    [[nodiscard]] ErrorTracking error_tracking() const noexcept { return m_error_tracking; }
+    [[nodiscard]] bool tracks_errors() const noexcept { return m_track_errors; }
+
+    // -----------------------------------------------------------------------
+    // Rule profiling (Profiler.h): NonTerminal::parse reports every rule
+    // application to the attached profiler. Null (the default) is off.
+    // -----------------------------------------------------------------------
+    void profiler(RuleProfiler* p) noexcept
+    {
+        m_profiler = p;
+        m_rule_hooks = m_profiler != nullptr || m_limited;
+    }
+    [[nodiscard]] RuleProfiler* profiler() const noexcept { return m_profiler; }
+
+    // -----------------------------------------------------------------------
+    // Resource limits (ParseLimits). NonTerminal::parse charges every rule
+    // application against them: the depth and the step budget on each one;
+    // the deadline, the cancel flag and the memory estimate when a parse
+    // starts and then every limit_check_interval applications, so the clock
+    // read and the atomic load are amortized. Terminals and combinators are
+    // not counted; a single rule body (say, a repetition of terminals) runs
+    // to its end before the next check.
+    //
+    // The first limit hit stops the parse down the committed-failure path:
+    // every enclosing combinator fails without trying further alternatives
+    // or recovery, and limit_exceeded() names the limit. Grammar::parse then
+    // returns false, parse_or_throw throws ParseLimitError (not ParseError),
+    // and Deferred error tracking skips its re-parse. The counters and the
+    // reason are reset when a Grammar entry point starts a parse.
+    // -----------------------------------------------------------------------
+    static constexpr std::uint64_t limit_check_interval = 256;
+
+    void limits(const ParseLimits& l) noexcept
+    {
+        m_limits = l;
+        m_limited = l.max_steps != 0 || l.max_memory != 0 || l.max_depth != 0 ||
+                    l.cancel != nullptr ||
+                    l.deadline != std::chrono::steady_clock::time_point::max();
+        m_rule_hooks = m_profiler != nullptr || m_limited;
+    }
+    [[nodiscard]] const ParseLimits& limits() const noexcept { return m_limits; }
+    [[nodiscard]] LimitKind limit_exceeded() const noexcept { return m_limit_hit; }
+    // Where the parse was when the limit was hit (the failure unwinds from
+    // there, so mark() afterwards is wherever the outermost rule rewound to).
+    [[nodiscard]] std::size_t limit_position() const noexcept { return m_limit_pos; }
+
+    // Rule applications in the current parse (counted only while a limit is
+    // set).
+    [[nodiscard]] std::uint64_t steps() const noexcept { return m_steps; }
+
+    // Profiling or limits are on: NonTerminal::parse takes its hooked path.
+    [[nodiscard]] bool rule_hooks() const noexcept { return m_rule_hooks; }
+
+    // Grammar entry points: a fresh budget, then the checks that need no
+    // rule application (a deadline already past, a cancel already set).
+    // After a stopped parse the memo is dropped first: the rules that were
+    // open when the limit hit cached failures they never really had.
+    void begin_limits()
+    {
+        if (m_limit_hit != LimitKind::None) {
+            m_mem.clear();
+            m_memo_entries = 0;
+            m_growing_head.clear();
+            m_lr_stack = nullptr;
+        }
+        m_limit_hit = LimitKind::None;
+        m_steps = 0;
+        m_depth = 0;
+        if (m_limited) {
+            check_periodic_limits();
+        }
+    }
+
+    // NonTerminal::parse, around each rule application. False: a limit is
+    // hit, fail without running the rule (and without limit_leave).
+    [[nodiscard]] bool limit_enter() noexcept
+    {
+        if (!m_limited) {
+            return true;
+        }
+        if (m_limit_hit == LimitKind::None) {
+            ++m_steps;
+            if (m_limits.max_depth != 0 && m_depth >= m_limits.max_depth) {
+                exceed(LimitKind::Depth);
+            } else if (m_limits.max_steps != 0 && m_steps > m_limits.max_steps) {
+                exceed(LimitKind::Steps);
+            } else if (m_steps % limit_check_interval == 0) {
+                check_periodic_limits();
+            }
+        }
+        if (m_limit_hit != LimitKind::None) {
+            return false;
+        }
+        ++m_depth;
+        return true;
+    }
+
+    void limit_leave() noexcept
+    {
+        if (m_limited) {
+            --m_depth;
+        }
+    }
+
+    // Reset for Deferred's tracked re-parse from `pos`: every memo entry was
+    // computed untracked (a replay would skip its failures), so the memo is
+    // dropped wholesale, along with the recovery diagnostics recorded since
+    // `diagnostics_mark` (the re-parse records them again). Tracking stays
+    // on until error_tracking() is set again.
+    void prepare_diagnostic_reparse(std::size_t pos, std::size_t diagnostics_mark)
+    {
+        m_mem.clear();
+        m_memo_entries = 0;
+        m_growing_head.clear();
+        m_lr_stack = nullptr;
+        m_committed_failure = false;
+        clear_error();
+        if (diagnostics_mark < m_diagnostics.size()) {
+            m_diagnostics.erase(m_diagnostics.begin() +
+                                    static_cast<std::ptrdiff_t>(diagnostics_mark),
+                                m_diagnostics.end());
+        }
+        std::erase_if(m_provisional_diagnostics,
+                      [diagnostics_mark](std::size_t i) { return i >= diagnostics_mark; });
+        m_track_errors = true;
+        m_position = pos;
+    }
+
     // Furthest-wins / same-position-accumulates / earlier-ignored.
-    void record_failure(std::size_t pos, ExpectedItem item)
+    void record_failure(std::size_t pos, ExpectedItem&& item)
     {
-        if (!m_has_error || pos > m_furthest_failure_pos) {
-            m_furthest_failure_pos = pos;
-            m_expected.clear();
-            m_expected.insert(std::move(item));
-            m_has_error = true;
-        } else if (pos == m_furthest_failure_pos) {
+        if (retains_failure_at(pos)) {
             m_expected.insert(std::move(item));
         }
     }
 
+    // Used by every built-in expression: records the expression's shared
+    // item (deduplicated by identity). Its text is copied into the set only
+    // when expected() / take_error() reads it. The pointer shares ownership,
+    // so the item stays valid after the expression is gone.
+    void record_failure(std::size_t pos, const SharedExpectedItem& item)
+    {
+        if (!retains_failure_at(pos)) {
+            return;
+        }
+        const auto live = m_expected_shared.begin() +
+                          static_cast<std::ptrdiff_t>(m_expected_shared_live);
+        if (std::find(m_expected_shared.begin(), live, item) != live) {
+            return;
+        }
+        // The same expressions tend to fail in the same order at each new
+        // furthest position; a slot that already holds `item` is reused
+        // without touching the reference count.
+        if (live == m_expected_shared.end()) {
+            m_expected_shared.push_back(item);
+        } else if (*live != item) {
+            *live = item;
+        }
+        ++m_expected_shared_live;
+    }
+
+    // The ref is rendered only if `pos` is furthest-or-tied, and right away:
+    // the set keeps the rendered item, not the ref.
+    void record_failure(std::size_t pos, ExpectedRef ref)
+    {
+        if (retains_failure_at(pos)) {
+            m_expected.insert(ref.render());
+        }
+    }
+
     // Lazy variant: the ExpectedItem is produced by `producer` ONLY if `pos` is
     // furthest-or-tied (i.e. it would actually be retained). This is the common
     // case under ordered-choice backtracking: terminal/token failures happen at
@@ -426,16 +959,18 @@ struct Context
     // through record_terminal_expected) wasted a std::string allocation +
     // snprintf/escape work on every discarded failure. Callers that already
     // have a cheap ExpectedItem should keep using the eager overload above.
+    // Built-in expressions record a SharedExpectedItem instead.
     template<typename Producer>
         requires std::invocable<Producer&> &&
                  std::convertible_to<std::invoke_result_t<Producer&>, ExpectedItem>
     void record_failure_lazy(std::size_t pos, Producer producer)
     {
+        if (!m_track_errors) {
+            return;
+        }
         if (!m_has_error || pos > m_furthest_failure_pos) {
-            m_furthest_failure_pos = pos;
-            m_expected.clear();
+            start_furthest(pos);
             m_expected.insert(producer());
-            m_has_error = true;
         } else if (pos == m_furthest_failure_pos) {
             m_expected.insert(producer());
         }
@@ -446,7 +981,12 @@ struct Context
     {
         return m_furthest_failure_pos;
     }
-    [[nodiscard]] const expected_set& expected() const noexcept { return m_expected; }
+    // Copies in any items still held as shared pointers first.
+    [[nodiscard]] const expected_set& expected() const
+    {
+        render_expected();
+        return m_expected;
+    }
     [[nodiscard]] bool has_error() const noexcept { return m_has_error; }
 
     // Move the error out as a Diagnostic. After this call, has_error() is false.
@@ -455,10 +995,9 @@ struct Context
         if (!m_has_error) {
             return std::nullopt;
         }
+        render_expected();
         Diagnostic diag{m_furthest_failure_pos, std::move(m_expected)};
-        m_has_error = false;
-        m_expected.clear();
-        m_furthest_failure_pos = 0;
+        clear_error();
         return diag;
     }
 
@@ -471,6 +1010,15 @@ struct Context
 
     void record_diagnostic(Diagnostic diag) { m_diagnostics.push_back(std::move(diag)); }
 
+    // The most recent diagnostic came from an evaluation that reached the end
+    // of a still-open input; prepare_resume() discards it because the re-drive
+    // records it again (or recovers differently).
+    void mark_last_diagnostic_provisional()
+    {
+        assert(!m_diagnostics.empty());
+        m_provisional_diagnostics.push_back(m_diagnostics.size() - 1);
+    }
+
     [[nodiscard]] const std::vector<Diagnostic>& diagnostics() const noexcept
     {
         return m_diagnostics;
@@ -478,40 +1026,165 @@ struct Context
     [[nodiscard]] std::vector<Diagnostic> take_diagnostics() { return std::move(m_diagnostics); }
 
 protected:
+    void start_furthest(std::size_t pos) noexcept
+    {
+        m_furthest_failure_pos = pos;
+        m_expected.clear();
+        m_expected_shared_live = 0;
+        m_has_error = true;
+    }
+
+    void render_expected() const
+    {
+        for (std::size_t i = 0; i < m_expected_shared_live; ++i) {
+            m_expected.insert(*m_expected_shared[i]);
+        }
+        m_expected_shared_live = 0;
+    }
+
+    // Whether a failure at `pos` is kept in the expected set; one past the
+    // current furthest position starts a new set.
+    bool retains_failure_at(std::size_t pos) noexcept
+    {
+        if (!m_track_errors) {
+            return false;
+        }
+        if (!m_has_error || pos > m_furthest_failure_pos) {
+            start_furthest(pos);
+            return true;
+        }
+        return pos == m_furthest_failure_pos;
+    }
+
+    void clear_error() noexcept
+    {
+        m_has_error = false;
+        m_expected.clear();
+        m_expected_shared_live = 0;
+        m_furthest_failure_pos = 0;
+    }
+
+    PushSource<CharT>& push_source()
+    {
+        auto* push = dynamic_cast<PushSource<CharT>*>(m_input.get());
+        if (push == nullptr) {
+            throw std::logic_error{"Context: input is not a PushSource"};
+        }
+        return *push;
+    }
+
     std::unique_ptr<InputSourceBase<CharT>> m_input;
     const CharT* m_fast_data;
+    // Paged sources' current page; owned by the source, so stable across
+    // Context moves (the source stays put behind m_input).
+    const InputWindow<CharT>* m_window = m_input->window();
+    // Backing store for view() spans that cross a page boundary.
+    mutable std::vector<CharT> m_view_scratch;
     std::size_t m_position = 0;
     std::size_t m_last_cut = 0;
     std::size_t m_input_size = 0;
+    mutable std::size_t m_end_hits = 0;
+    // Input size when the current attempt started (prepare_resume).
+    std::size_t m_attempt_size = 0;
     // Node arena: owns every ParseTreeNode for this parse's lifetime. A deque
     // gives stable element addresses across growth and frees all nodes on
     // Context destruction with no per-node deallocation. See make_node().
     std::deque<ParseTreeNode> m_node_arena;
-    // Packrat memo. Two-level, keyed by (position → rule*). Both layers are
-    // hash maps rather than red-black trees: the callgrind baseline showed
-    // std::map node allocation + descent as the single largest hotspot
-    // (~30% of instruction refs) — two RB-tree node allocs per first-time
-    // (rule, pos) entry and two descents per lookup. unordered_map trades
-    // that for one hash probe + amortized bucket storage per layer, with no
-    // per-entry heap node on a hit. The two-level shape (not a single flat
-    // (pos, rule*) map) is deliberate: clear_siblings_at must iterate every
-    // rule AT a given position each left-recursion growth iteration, and a
-    // flat map would make that a full-table scan (O(total entries) per
+    std::size_t m_arena_used = 0; // nodes handed out; the rest are spare
+    // Packrat memo. Two-level, keyed by (position → rule*). The inner layer
+    // is a short vector per position rather than a red-black tree or a hash
+    // map: the callgrind baseline showed std::map node allocation + descent
+    // as the single largest hotspot (~30% of instruction refs), and a hash
+    // map still allocated a node per entry. The outer layer is
+    // position-ordered blocks (MemoTable.h), so a cut releases the positions
+    // behind it without scanning the rest. The two-level shape (not a single
+    // flat (pos, rule*) map) is deliberate: clear_siblings_at must iterate
+    // every rule AT a given position each left-recursion growth iteration,
+    // and a flat map would make that a full-table scan (O(total entries) per
     // growth step → quadratic on left-recursive grammars).
-    std::unordered_map<std::size_t, std::unordered_map<const NonTerminalType*, RuleState>> m_mem;
-    std::stack<CutRecord> m_cut;
+    using Memo = MemoTable<const NonTerminalType*, RuleState>;
+    Memo m_mem;
+    // Vector-backed: a deque frees and reallocates a chunk each time the
+    // depth crosses a chunk boundary; a vector keeps its capacity.
+    std::stack<CutRecord, std::vector<CutRecord>> m_cut;
+    bool m_committed_failure = false;
 
     LRFrame* m_lr_stack = nullptr;
-    std::unordered_map<std::size_t, const NonTerminalType*> m_growing_head;
+    // (position, head) for each head whose growth loop is running. Heads
+    // nest on the C++ stack, so there are a few at most: a vector scanned
+    // linearly, which allocates nothing once it has grown.
+    std::vector<std::pair<std::size_t, const NonTerminalType*>> m_growing_head;
 
+    auto find_growing_head(std::size_t pos) noexcept
+    {
+        return std::find_if(m_growing_head.begin(), m_growing_head.end(), [pos](const auto& h) {
+            return h.first == pos;
+        });
+    }
+    auto find_growing_head(std::size_t pos) const noexcept
+    {
+        return std::find_if(m_growing_head.begin(), m_growing_head.end(), [pos](const auto& h) {
+            return h.first == pos;
+        });
+    }
+
+    // Expected set at the furthest position: owned items, plus the first
+    // m_expected_shared_live shared ones, not copied in yet. Slots past that
+    // are kept for reuse by record_failure. Mutable so the const expected()
+    // can copy them in.
     std::size_t m_furthest_failure_pos = 0;
-    expected_set m_expected;
+    mutable expected_set m_expected;
+    mutable std::vector<SharedExpectedItem> m_expected_shared;
+    mutable std::size_t m_expected_shared_live = 0;
     bool m_has_error = false;
+    ErrorTracking m_error_tracking = ErrorTracking::Full;
+    bool m_track_errors = true;
 
     std::vector<Diagnostic> m_diagnostics;
+    std::vector<std::size_t> m_provisional_diagnostics;
 
     const NonTerminalType* m_skipper = nullptr;
     bool m_skip_enabled = true;
+
+    RuleProfiler* m_profiler = nullptr;
+    bool m_rule_hooks = false;
+
+    ParseLimits m_limits;
+    bool m_limited = false;
+    LimitKind m_limit_hit = LimitKind::None;
+    std::size_t m_limit_pos = 0;
+    std::uint64_t m_steps = 0;
+    std::size_t m_depth = 0;
+    std::size_t m_memo_entries = 0;
+
+    // O(1) estimate behind ParseLimits::max_memory: this parse's counts
+    // times element sizes, with one child link per node. Capacity kept from
+    // earlier parses is not counted.
+    [[nodiscard]] std::size_t approx_bytes() const noexcept
+    {
+        return m_arena_used * (sizeof(ParseTreeNode) + sizeof(void*)) +
+               m_mem.block_count() * Memo::block_bytes +
+               m_memo_entries * sizeof(typename Memo::Slot::value_type);
+    }
+
+    void exceed(LimitKind kind) noexcept
+    {
+        m_limit_hit = kind;
+        m_limit_pos = m_position;
+        commit_failure();
+    }
+
+    void check_periodic_limits() noexcept
+    {
+        if (m_limits.cancel != nullptr && m_limits.cancel->load(std::memory_order_relaxed)) {
+            exceed(LimitKind::Cancelled);
+        } else if (m_limits.max_memory != 0 && approx_bytes() > m_limits.max_memory) {
+            exceed(LimitKind::Memory);
+        } else if (m_limits.deadline != std::chrono::steady_clock::time_point::max() &&
+                   std::chrono::steady_clock::now() >= m_limits.deadline) {
+            exceed(LimitKind::Deadline);
+        }
+    }
 };
 
 template<typename CharT, std::size_t PageSize = 4096>
@@ -520,6 +1193,27 @@ auto from_file(const std::string& path)
     return Context<CharT>(FileSource<CharT, PageSize>(path));
 }
 
+// Context over an N-page LRU file cache; see PagedFileOptions.
+template<typename CharT>
+auto from_paged_file(const std::string& path, PagedFileOptions options = {})
+{
+    return Context<CharT>(PagedFileSource<CharT>(path, options));
+}
+
+// Context over a memory-mapped file; same hot path as an in-memory range.
+template<typename CharT>
+auto from_mmap(const std::string& path)
+{
+    return Context<CharT>(MmapSource<CharT>(path));
+}
+
+// Context over an initially empty PushSource; feed it as input arrives.
+template<typename CharT>
+auto from_push()
+{
+    return Context<CharT>(PushSource<CharT>{});
+}
+
 template<typename Range>
 Context(const Range&) -> Context<typename Range::value_type>;
 
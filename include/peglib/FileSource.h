@@ -9,6 +9,10 @@
 // Thread safety: NOT thread-safe — buffer cache is mutable and mutated by
 // const-looking accessors (re-fill on cache miss); concurrent reads race.
 //
+// Window: the buffer that served the last get() is published as an
+// InputWindow (see InputWindow.h) so Context can index it directly; only
+// accesses outside it come back through get().
+//
 // Large files: fseek uses a `long` offset, which on platforms where `long`
 // is 32-bit cannot address files larger than ~2 GiB. Not a concern on LP64.
 #pragma once
@@ -17,6 +21,9 @@
 #include <cstdio>
 #include <filesystem>
 #include <string>
+
+#include "InputWindow.h"
+
 namespace peg
 {
 
@@ -41,6 +48,7 @@ struct FileSource
             if (n0 == PageSize) {
                 m_bufs[1].read(m_fp, PageSize);
             }
+            publish_window();
         } catch (...) {
             std::fclose(m_fp);
             m_fp = nullptr;
@@ -59,6 +67,8 @@ struct FileSource
         rhs.m_fp = nullptr;
         rhs.m_filesize = 0;
         rhs.m_current_buf = 0;
+        rhs.m_window = {};
+        publish_window(); // the arrays moved with *this
     }
 
     FileSource& operator=(FileSource&&) = delete;
@@ -84,12 +94,14 @@ struct FileSource
         const int other = m_current_buf ^ 1;
         if (m_bufs[other].in(i)) {
             m_current_buf = other;
+            publish_window();
             return m_bufs[m_current_buf].get_unchecked(i);
         }
         if (!read_to(i.m_pos, 0)) {
             assert(false && "FileSource::get: read_to failed for in-range position");
         }
         m_current_buf = 0;
+        publish_window();
         return m_bufs[m_current_buf].get_unchecked(i);
     }
 
@@ -104,6 +116,15 @@ struct FileSource
                 buf.clear();
             }
         }
+        publish_window();
+    }
+
+    const InputWindow<value_type>& window() const noexcept { return m_window; }
+
+    // Number of the two buffers currently holding data.
+    std::size_t resident_pages() const noexcept
+    {
+        return (m_bufs[0].m_valid_count != 0 ? 1 : 0) + (m_bufs[1].m_valid_count != 0 ? 1 : 0);
     }
 
     struct iterator
@@ -210,8 +231,15 @@ protected:
     size_t m_filesize = 0;
     mutable buffer m_bufs[2];
     mutable int m_current_buf = 0;
+    mutable InputWindow<value_type> m_window;
     FILE* m_fp = nullptr;
 
+    void publish_window() const
+    {
+        const buffer& b = m_bufs[m_current_buf];
+        m_window = {b.m_buf.data(), b.m_buf_from, b.m_buf_to};
+    }
+
     bool read_to(size_t item_pos, int index) const
     {
         if (item_pos >= m_filesize) {
@@ -0,0 +1,501 @@
+// Grammar-directed input generation: random inputs a grammar accepts, and
+// near-miss inputs it rejects, for benchmark corpora and differential
+// fuzzing.
+//
+//   auto text = peg::generate(g, "json", {.seed = 7, .target_size = 4096});
+//   auto bad  = peg::generate_invalid(g, "json", {.seed = 7});
+//
+// Every expression type implements two hooks next to parse() (see
+// ParsingExprInterface): generate_cost(), the height of the shallowest
+// derivation it can produce (`Generator::unbounded` if it can produce
+// none), and generate(), which appends one derivation to the Generator's
+// output. Rules contribute one level of height; their costs are solved as a
+// fixpoint over the rule graph the first time one is asked for, so
+// recursive and mutually recursive rules get a finite cost whenever some
+// alternative bottoms out.
+//
+// Shape of the output:
+//   - Alternation picks a branch at random among those with a finite cost
+//     (uniformly, or by GenerateOptions::weights for a named rule). Once the
+//     output has reached target_size, or rule nesting has reached
+//     max_depth, it picks the cheapest branch instead — every such choice
+//     strictly lowers the remaining height, so generation terminates.
+//   - The outermost unbounded repetition over rules (a document's
+//     statement list, a top-level array's elements) keeps iterating until
+//     target_size is reached; nested ones, and repetitions of plain
+//     terminals (whitespace, digits), draw a geometric count with mean
+//     `repeat_mean`. Bounded repetitions draw uniformly between their
+//     limits.
+//   - Terminals emit a matching element: the value, a random member of a
+//     set or range, or a sampled element a predicate accepts (random
+//     printable ASCII first, then a scan of the single-byte values).
+//   - Predicates (! and &) and cuts emit nothing; matchers cannot be
+//     inverted, so a branch through one is never chosen.
+//   - GenerateOptions::separator is emitted wherever the skipper would run
+//     (between sequence children and repetition iterations) outside
+//     lexeme(...), for grammars whose tokens need whitespace between them.
+//
+// A draw that ends below half of target_size (a leaf chosen before any
+// repetition could fill) is set aside and the next one tried; the largest
+// is returned if no draw reaches that size.
+//
+// A derivation is not always a parse: ordered choice can take an earlier
+// branch that matches a prefix of a later branch's output, and a greedy
+// repetition can swallow what follows it. generate() therefore parses each
+// candidate and retries with a fresh draw (up to `attempts` times) until
+// the grammar accepts the whole of it. generate_invalid() applies one
+// mutation (replace, insert, delete or truncate, using elements the
+// grammar itself emitted) to a valid input and keeps it only if the
+// grammar now rejects it.
+//
+// Deterministic: the same grammar, rule and options give the same output
+// on every platform (splitmix64, no <random> distributions).
+#pragma once
+#include "peglib/Context.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace peg
+{
+
+struct GenerateOptions
+{
+    std::uint64_t seed = 1;
+    std::size_t target_size = 256; // elements; past this, take cheapest branches
+    std::size_t max_depth = 32;    // rule nesting; past this, take cheapest branches
+    std::size_t repeat_mean = 2;   // mean iterations of a nested * / +
+    std::size_t attempts = 64;     // candidates tried before giving up
+    // Per-rule alternative weights, applied to the first alternation
+    // generated in that rule's body (normally its top-level choice).
+    // Missing or extra entries count as weight 1 / are ignored.
+    std::map<std::string, std::vector<double>> weights;
+    // Emitted between sequence children and repetition iterations outside
+    // lexeme(...) — set it (e.g. " ") for grammars with a skipper.
+    std::string separator;
+};
+
+// A generated input: a string for character grammars, a vector of elements
+// for token grammars.
+template<typename CharT>
+using GeneratedInput =
+    std::conditional_t<std::is_same_v<CharT, char> || std::is_same_v<CharT, wchar_t> ||
+                           std::is_same_v<CharT, char8_t> || std::is_same_v<CharT, char16_t> ||
+                           std::is_same_v<CharT, char32_t>,
+                       std::basic_string<CharT>,
+                       std::vector<CharT>>;
+
+// State of one generate() call, threaded through the expression hooks.
+template<typename CharT>
+class Generator
+{
+public:
+    static constexpr std::size_t unbounded = std::numeric_limits<std::size_t>::max();
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    explicit Generator(const GenerateOptions& options) : m_options{options}, m_state{options.seed}
+    {}
+
+    // Start a new candidate: empty output, fresh draws. Rule costs are kept.
+    void restart(std::uint64_t seed)
+    {
+        m_out.clear();
+        m_state = seed;
+        m_depth = 0;
+        m_repeat_depth = 0;
+        m_lexeme = false;
+        m_pending_weights = nullptr;
+    }
+
+    [[nodiscard]] const std::vector<CharT>& output() const noexcept { return m_out; }
+    [[nodiscard]] const GenerateOptions& options() const noexcept { return m_options; }
+
+    // -----------------------------------------------------------------------
+    // Randomness.
+    // -----------------------------------------------------------------------
+    std::uint64_t next() noexcept
+    {
+        std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, n); n > 0.
+    std::size_t below(std::size_t n) noexcept { return static_cast<std::size_t>(next() % n); }
+    // Uniform in [0, 1).
+    double unit() noexcept { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+
+    // -----------------------------------------------------------------------
+    // Output.
+    // -----------------------------------------------------------------------
+    void emit(const CharT& value)
+    {
+        m_out.push_back(value);
+        remember(value);
+    }
+
+    // Emit one element matching a terminal's value: the value itself, a
+    // range [lo, hi], a set, or a predicate. Returns false if no element
+    // could be produced (an empty set, or a predicate nothing sampled meets).
+    template<typename V>
+    bool emit_matching(const V& value)
+    {
+        if constexpr (std::is_same_v<V, CharT>) {
+            emit(value);
+            return true;
+        } else if constexpr (requires {
+                                 std::get<0>(value);
+                                 std::get<1>(value);
+                             }) {
+            const CharT& lo = std::get<0>(value);
+            const CharT& hi = std::get<1>(value);
+            if constexpr (std::is_integral_v<CharT>) {
+                const auto span = static_cast<std::uint64_t>(hi) - static_cast<std::uint64_t>(lo);
+                emit(static_cast<CharT>(lo + static_cast<CharT>(next() % (span + 1))));
+            } else {
+                emit(lo);
+            }
+            return true;
+        } else if constexpr (requires {
+                                 value.begin();
+                                 value.end();
+                                 value.size();
+                             }) {
+            if (value.size() == 0) {
+                return false;
+            }
+            auto it = value.begin();
+            for (std::size_t i = below(value.size()); i > 0; --i) {
+                ++it;
+            }
+            emit(*it);
+            return true;
+        } else if constexpr (std::is_invocable_r_v<bool, const V&, CharT> &&
+                             std::is_integral_v<CharT>) {
+            // Random printable ASCII first, then a scan of 0..255.
+            for (std::size_t i = 0; i < 256; ++i) {
+                const auto c = static_cast<CharT>(0x20 + below(95));
+                if (value(c)) {
+                    emit(c);
+                    return true;
+                }
+            }
+            for (unsigned i = 0; i < 256; ++i) {
+                const auto c = static_cast<CharT>(i);
+                if (value(c)) {
+                    emit(c);
+                    return true;
+                }
+            }
+            return false;
+        } else {
+            return false;
+        }
+    }
+
+    // Called where the skipper would run.
+    void separate()
+    {
+        if (!m_lexeme) {
+            for (char c : m_options.separator) {
+                if constexpr (std::is_convertible_v<char, CharT>) {
+                    m_out.push_back(static_cast<CharT>(c));
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] bool lexeme() const noexcept { return m_lexeme; }
+    void lexeme(bool on) noexcept { m_lexeme = on; }
+
+    // -----------------------------------------------------------------------
+    // Choices.
+    // -----------------------------------------------------------------------
+
+    // Past target_size or max_depth: every choice takes the cheapest option.
+    [[nodiscard]] bool closing() const noexcept
+    {
+        return m_out.size() >= m_options.target_size || m_depth >= m_options.max_depth;
+    }
+
+    // Pick an alternative given each one's cost; npos if none is finite.
+    std::size_t choose(std::span<const std::size_t> costs)
+    {
+        const std::vector<double>* weights = m_pending_weights;
+        m_pending_weights = nullptr;
+        if (closing()) {
+            std::size_t best = npos;
+            for (std::size_t i = 0; i < costs.size(); ++i) {
+                if (costs[i] != unbounded && (best == npos || costs[i] < costs[best])) {
+                    best = i;
+                }
+            }
+            return best;
+        }
+        double total = 0;
+        for (std::size_t i = 0; i < costs.size(); ++i) {
+            total += weight(weights, i, costs[i]);
+        }
+        if (total <= 0) {
+            return npos;
+        }
+        double r = unit() * total;
+        std::size_t last = npos;
+        for (std::size_t i = 0; i < costs.size(); ++i) {
+            const double w = weight(weights, i, costs[i]);
+            if (w > 0) {
+                last = i;
+                if (r < w) {
+                    return i;
+                }
+                r -= w;
+            }
+        }
+        return last; // rounding
+    }
+
+    // Iterations for a repetition with limits [min_rep, max_rep]
+    // (max_rep < 0: unbounded) whose child reaches rules (`structural`) or
+    // only terminals. Returns `unbounded` when the caller should iterate
+    // until closing(): the outermost structural unbounded repetition.
+    std::size_t repetitions(std::size_t min_rep, std::int64_t max_rep, bool structural)
+    {
+        if (closing()) {
+            return min_rep;
+        }
+        if (max_rep >= 0) {
+            const auto max = static_cast<std::size_t>(max_rep);
+            return min_rep + below(max - min_rep + 1);
+        }
+        if (structural && m_repeat_depth == 1) {
+            return unbounded;
+        }
+        // Geometric with mean repeat_mean.
+        std::size_t n = min_rep;
+        const double p_more =
+            static_cast<double>(m_options.repeat_mean) / (1.0 + m_options.repeat_mean);
+        while (unit() < p_more) {
+            ++n;
+        }
+        return n;
+    }
+
+    // Bracket a structural repetition (see repetitions()).
+    void enter_repetition() noexcept { ++m_repeat_depth; }
+    void leave_repetition() noexcept { --m_repeat_depth; }
+
+    // -----------------------------------------------------------------------
+    // Rules.
+    // -----------------------------------------------------------------------
+    void enter_rule(const std::string& name)
+    {
+        ++m_depth;
+        auto it = m_options.weights.find(name);
+        m_pending_weights = it == m_options.weights.end() ? nullptr : &it->second;
+    }
+    void leave_rule() noexcept { --m_depth; }
+
+    // Cost of a rule: 1 + the cost of its body. `body_cost(gen)` evaluates
+    // the body against the current estimates. The first query solves the
+    // fixpoint over every rule reachable from `rule`; later ones are lookups.
+    template<typename BodyCost>
+    std::size_t rule_cost(const void* rule, BodyCost body_cost)
+    {
+        auto [it, inserted] = m_rule_index.try_emplace(rule, m_rules.size());
+        if (inserted) {
+            m_rules.push_back(RuleCost{unbounded, body_cost});
+        }
+        if (m_solving) {
+            return m_rules[it->second].cost;
+        }
+        m_solving = true;
+        for (bool changed = true; changed;) {
+            changed = false;
+            // By index: solving a body may register further rules.
+            for (std::size_t i = 0; i < m_rules.size(); ++i) {
+                const std::size_t body = m_rules[i].body_cost(*this);
+                const std::size_t cost = body == unbounded ? unbounded : body + 1;
+                if (cost < m_rules[i].cost) {
+                    m_rules[i].cost = cost;
+                    changed = true;
+                }
+            }
+        }
+        m_solving = false;
+        return m_rules[m_rule_index.at(rule)].cost;
+    }
+
+    // Elements the grammar has emitted so far, in first-seen order (the
+    // alphabet for near-miss mutations).
+    [[nodiscard]] const std::vector<CharT>& alphabet() const noexcept { return m_alphabet; }
+
+private:
+    struct RuleCost
+    {
+        std::size_t cost;
+        std::function<std::size_t(Generator&)> body_cost;
+    };
+
+    static double weight(const std::vector<double>* weights, std::size_t i, std::size_t cost)
+    {
+        if (cost == unbounded) {
+            return 0;
+        }
+        if (weights != nullptr && i < weights->size()) {
+            return (*weights)[i] > 0 ? (*weights)[i] : 0;
+        }
+        return 1;
+    }
+
+    void remember(const CharT& value)
+    {
+        if (m_alphabet.size() < 256) {
+            for (const auto& v : m_alphabet) {
+                if (v == value) {
+                    return;
+                }
+            }
+            m_alphabet.push_back(value);
+        }
+    }
+
+    const GenerateOptions& m_options;
+    std::uint64_t m_state;
+    std::vector<CharT> m_out;
+    std::vector<CharT> m_alphabet;
+    std::size_t m_depth = 0;
+    std::size_t m_repeat_depth = 0;
+    bool m_lexeme = false;
+    const std::vector<double>* m_pending_weights = nullptr;
+    std::vector<RuleCost> m_rules;
+    std::map<const void*, std::size_t> m_rule_index;
+    bool m_solving = false;
+};
+
+namespace detail
+{
+template<typename GrammarT, typename Input>
+bool accepts(const GrammarT& g, std::string_view rule, const Input& input)
+{
+    typename GrammarT::Context ctx{input};
+    ctx.error_tracking(ErrorTracking::Off);
+    return g.parse(rule, ctx) && ctx.ended();
+}
+
+// The candidate loop behind generate(). `gen` keeps the alphabet of every
+// candidate, for generate_invalid().
+template<typename GrammarT, typename CharT>
+std::optional<GeneratedInput<CharT>>
+generate_valid(const GrammarT& g, std::string_view rule, Generator<CharT>& gen)
+{
+    const auto r = g.find(rule);
+    if (!r || !r->is_defined()) {
+        return std::nullopt;
+    }
+    const GenerateOptions& options = gen.options();
+    std::optional<GeneratedInput<CharT>> best;
+    for (std::size_t attempt = 0; attempt < options.attempts; ++attempt) {
+        // Each candidate is an independent draw seeded from the options.
+        gen.restart(options.seed ^ (0xd1b54a32d192ed03ULL * (attempt + 1)));
+        if (!r->impl()->generate(gen)) {
+            continue;
+        }
+        if (best && gen.output().size() <= best->size()) {
+            continue;
+        }
+        GeneratedInput<CharT> input(gen.output().begin(), gen.output().end());
+        if (accepts(g, rule, input)) {
+            // A draw that closed early (a leaf picked before any
+            // repetition could fill) is kept only until a larger one parses.
+            if (input.size() * 2 >= options.target_size) {
+                return input;
+            }
+            best = std::move(input);
+        }
+    }
+    return best;
+}
+} // namespace detail
+
+// An input that `rule` of `g` matches in full, or std::nullopt if none of
+// `options.attempts` candidates parsed (or the rule is not defined, or no
+// derivation avoids an un-invertible matcher). Deterministic in the
+// options.
+template<typename GrammarT>
+auto generate(const GrammarT& g, std::string_view rule, const GenerateOptions& options = {})
+    -> std::optional<GeneratedInput<typename GrammarT::Context::value_type>>
+{
+    Generator<typename GrammarT::Context::value_type> gen{options};
+    return detail::generate_valid(g, rule, gen);
+}
+
+// Convenience form of the above.
+template<typename GrammarT>
+auto generate(const GrammarT& g,
+              std::string_view rule,
+              std::uint64_t seed,
+              std::size_t target_size)
+{
+    GenerateOptions options;
+    options.seed = seed;
+    options.target_size = target_size;
+    return generate(g, rule, options);
+}
+
+// A near miss: a valid input (as generate()) with one mutation — an element
+// replaced, inserted or deleted, or the input truncated — that `rule` of `g`
+// no longer matches in full. std::nullopt if no valid input was found or
+// no mutation within `options.attempts` tries made it invalid.
+template<typename GrammarT>
+auto generate_invalid(const GrammarT& g,
+                      std::string_view rule,
+                      const GenerateOptions& options = {})
+    -> std::optional<GeneratedInput<typename GrammarT::Context::value_type>>
+{
+    Generator<typename GrammarT::Context::value_type> gen{options};
+    const auto valid = detail::generate_valid(g, rule, gen);
+    if (!valid) {
+        return std::nullopt;
+    }
+    const auto alphabet = gen.alphabet();
+    for (std::size_t attempt = 0; attempt < options.attempts; ++attempt) {
+        auto input = *valid;
+        // Replace and insert need an element to write; an input made only of
+        // separators has none, and an empty input can only grow.
+        const std::size_t kinds = alphabet.empty() ? 2 : 4;
+        if (input.empty() && alphabet.empty()) {
+            return std::nullopt;
+        }
+        const std::size_t pos = input.empty() ? 0 : gen.below(input.size());
+        switch (input.empty() ? 3 : gen.below(kinds)) {
+        case 0: // delete
+            input.erase(input.begin() + static_cast<std::ptrdiff_t>(pos));
+            break;
+        case 1: // truncate
+            input.erase(input.begin() + static_cast<std::ptrdiff_t>(pos), input.end());
+            break;
+        case 2: // replace
+            input[pos] = alphabet[gen.below(alphabet.size())];
+            break;
+        default: // insert
+            input.insert(input.begin() + static_cast<std::ptrdiff_t>(pos),
+                         alphabet[gen.below(alphabet.size())]);
+            break;
+        }
+        if (!detail::accepts(g, rule, input)) {
+            return input;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace peg
@@ -8,7 +8,8 @@
 //   g.parse_string("1+2+3");  // convenience: creates a Context internally
 //
 // Rules are lazily created on first access via operator[]. The same Grammar
-// can parse many inputs — each parse gets a fresh Context.
+// can parse many inputs — each parse gets a fresh Context, or reuses one
+// (Context::rebind, parse_view).
 //
 // **Lifetime constraint**: Rule (the handle returned by operator[]) stores a
 // bare NonTerminal*, not a shared_ptr. This eliminates shared_ptr cycles in
@@ -20,6 +21,9 @@
 #include "peglib/Terminals.h"
 
 #include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -32,6 +36,38 @@
 namespace peg
 {
 
+// Outcome of Grammar::parse_async.
+enum class ParseStatus
+{
+    Matched,       // the rule matched; the answer cannot change with more input
+    Failed,        // the rule failed; the answer cannot change with more input
+    NeedMoreInput, // the answer depends on input not yet fed — feed and retry
+};
+
+// Per-phase breakdown of one Grammar::parse_ast call, filled by its
+// out-parameter overload. Times are steady_clock nanoseconds. `nodes` is
+// the arena nodes built during the phase for skip and tree (backtracked
+// ones included), and the committed tree nodes walked for on_match and
+// fold. Under ErrorTracking::Deferred a failed parse's tracked re-run
+// counts toward skip and tree.
+struct ParsePhaseStats
+{
+    struct Phase
+    {
+        std::uint64_t ns = 0;
+        std::size_t nodes = 0;
+    };
+    Phase skip;     // leading skipper at the grammar boundary
+    Phase tree;     // the rule's parse (the tree build)
+    Phase on_match; // the on_match hook walk
+    Phase fold;     // the typed fold into NodeType
+
+    [[nodiscard]] std::uint64_t total_ns() const noexcept
+    {
+        return skip.ns + tree.ns + on_match.ns + fold.ns;
+    }
+};
+
 template<typename CharT = char, typename NodeType = std::monostate>
     requires PegContext<Context<CharT, NodeType>>
 class Grammar
@@ -176,7 +212,7 @@ public:
 
     [[nodiscard]] std::optional<Rule> find(std::string_view name) const
     {
-        auto it = m_rules.find(std::string{name});
+        auto it = m_rules.find(name);
         if (it == m_rules.end())
             return std::nullopt;
         return Rule{it->second.get(), it->first};
@@ -184,7 +220,7 @@ public:
 
     [[nodiscard]] bool has_rule(std::string_view name) const
     {
-        return m_rules.find(std::string{name}) != m_rules.end();
+        return m_rules.find(name) != m_rules.end();
     }
 
     [[nodiscard]] std::vector<std::string> rule_names() const
@@ -227,11 +263,14 @@ public:
     [[nodiscard]] bool has_skipper() const noexcept { return m_skipper != nullptr; }
 
     // Parse using the start rule. Returns true on success, false on any
-    // failure (regular or cut-committed). Cut-committed failures (thrown
-    // internally as peg::ParseError from the Alternation/Repetition that owned
-    // the cut scope) are caught and surfaced as a normal failure: retrieve
-    // the diagnostic via ctx.take_error(). Throws std::logic_error if no
-    // start rule is set; std::out_of_range if `rule` is not defined.
+    // failure (regular or cut-committed). A cut-committed failure propagates
+    // out of the Alternation/Repetition that owned the cut scope as an
+    // ordinary failed result (no exception; ctx.committed_failure() tells the
+    // two kinds apart): retrieve the diagnostic via ctx.take_error(). Callers
+    // that prefer an exception use parse_or_throw. Under ErrorTracking::Deferred a
+    // failed parse is re-run with tracking on before returning, so the
+    // diagnostic is there as usual. Throws std::logic_error if no start rule
+    // is set; std::out_of_range if `rule` is not defined.
     bool parse(Context& ctx) const
     {
         if (m_start.empty()) {
@@ -242,39 +281,91 @@ public:
 
     bool parse(std::string_view rule, Context& ctx) const
     {
-        auto it = m_rules.find(std::string{rule});
+        auto it = m_rules.find(rule);
         if (it == m_rules.end()) {
             throw std::out_of_range{"Grammar::parse: rule '" + std::string{rule} + "' not found"};
         }
-        ctx.internal_set_skipper(m_skipper);
-        // Pest-style leading whitespace: consume at the grammar boundary so
-        // users don't need `g["ws"] >>` prefix. Trailing whitespace is
-        // intentionally NOT consumed (partial-match); for full-input
-        // consumption append `>> !.` (EndOfFile) to the start rule.
-        ctx.run_skipper();
-        try {
-            return it->second->parse(ctx).success;
-        } catch (const ParseError&) {
-            return false;
+        return run_rule(*it->second, ctx).success;
+    }
+
+    // As parse(), but a cut-committed failure throws peg::ParseError
+    // (carrying the furthest-failure diagnostic) instead of returning false,
+    // and a parse stopped by the Context's limits throws peg::ParseLimitError.
+    // Regular failures still return false.
+    bool parse_or_throw(Context& ctx) const
+    {
+        if (m_start.empty()) {
+            throw std::logic_error{"Grammar::parse_or_throw: no start rule set"};
+        }
+        return parse_or_throw(m_start, ctx);
+    }
+
+    bool parse_or_throw(std::string_view rule, Context& ctx) const
+    {
+        if (parse(rule, ctx)) {
+            return true;
+        }
+        if (ctx.limit_exceeded() != LimitKind::None) {
+            throw ParseLimitError{ctx.limit_exceeded(), ctx.limit_position()};
+        }
+        if (ctx.committed_failure()) {
+            auto err = ctx.take_error();
+            throw err ? ParseError{err->position(), err->expected()}
+                      : ParseError{ctx.mark(), ExpectedSet{}};
         }
+        return false;
+    }
+
+    // Resumable parse over a push-fed Context (from_push / PushSource). Runs
+    // the rule over the input buffered so far. If the outcome depended on the
+    // end of that buffer while the source is still open, returns
+    // NeedMoreInput instead of a premature failure (or a premature success —
+    // `*digit` that stopped at the buffer end might match further). Feed more
+    // input with ctx.feed() and call again; once ctx.close_input() has been
+    // called the result is definitive. A parse stopped by the Context's
+    // limits is Failed (see ctx.limit_exceeded()), open input or not.
+    //
+    // Resumption is memo-preserving rather than a suspended call stack: every
+    // memo entry whose evaluation did not reach the buffered end is kept and
+    // replays on the re-drive, so a retry re-parses only the frontier (the
+    // rule applications that were still open when input ran out) rather than
+    // the whole message. Cut stack and LR frames are transient per attempt
+    // and are rebuilt by the re-drive. The cost per retry is one memo-hit
+    // chain down to the frontier plus one sweep of the memo.
+    //
+    // Matchers (g.matcher) must test their scan bound with ctx.ended_at(pos)
+    // for the frontier to be tracked through them. After Matched, the tree is
+    // one memo hit away: ctx.reset(0) and call parse_tree.
+    ParseStatus parse_async(Context& ctx) const
+    {
+        if (m_start.empty()) {
+            throw std::logic_error{"Grammar::parse_async: no start rule set"};
+        }
+        return parse_async(m_start, ctx);
+    }
+
+    ParseStatus parse_async(std::string_view rule, Context& ctx) const
+    {
+        ctx.prepare_resume();
+        const std::size_t end_hits = ctx.end_hits();
+        const bool ok = parse(rule, ctx);
+        if (ctx.input_open() && ctx.end_hits() != end_hits &&
+            ctx.limit_exceeded() == LimitKind::None) {
+            return ParseStatus::NeedMoreInput;
+        }
+        return ok ? ParseStatus::Matched : ParseStatus::Failed;
     }
 
     // Parse and return the tree (nullptr on failure). Pure structure for
     // introspection (offsets, children, names) — no value slot, no hooks fire.
     typename Context::ParseTreeNodePtr parse_tree(std::string_view rule, Context& ctx) const
     {
-        auto it = m_rules.find(std::string{rule});
+        auto it = m_rules.find(rule);
         if (it == m_rules.end()) {
             throw std::out_of_range{"Grammar::parse_tree: rule '" + std::string{rule} +
                                     "' not found"};
         }
-        ctx.internal_set_skipper(m_skipper);
-        ctx.run_skipper();
-        try {
-            return it->second->parse(ctx).tree;
-        } catch (const ParseError&) {
-            return nullptr;
-        }
+        return run_rule(*it->second, ctx).tree;
     }
 
     // Parse and fold the result tree into a typed AST value (the two-phase
@@ -286,31 +377,45 @@ public:
     // Returns std::nullopt on parse failure or a null tree.
     std::optional<NodeType> parse_ast(std::string_view rule, Context& ctx) const
     {
-        auto it = m_rules.find(std::string{rule});
-        if (it == m_rules.end()) {
-            throw std::out_of_range{"Grammar::parse_ast: rule '" + std::string{rule} +
-                                    "' not found"};
-        }
-        auto tree = parse_tree(rule, ctx);
-        if (!tree)
-            return std::nullopt;
-        parsers::fire_on_match<Context, typename Context::ParseTreeNodePtr>(ctx, tree, it->second);
-        return parsers::fold_start<Context, typename Context::ParseTreeNodePtr>(
-            ctx, tree, it->second);
+        return parse_ast_impl(rule, ctx, nullptr);
+    }
+
+    // As above, also recording where the time went (see ParsePhaseStats).
+    // `stats` is overwritten; phases that did not run (on_match and fold
+    // after a failed parse) stay zero. The cost is two clock reads per
+    // phase.
+    std::optional<NodeType>
+    parse_ast(std::string_view rule, Context& ctx, ParsePhaseStats& stats) const
+    {
+        stats = {};
+        return parse_ast_impl(rule, ctx, &stats);
     }
 
     // Convenience: parse a string input using the start rule. Partial-match
     // semantics: returns true if the start rule matches at the beginning of
     // `input`, EVEN IF input remains unconsumed. To require the whole input
-    // be consumed, append `!.` (EndOfFile) to the start rule. Makes its own
-    // copy of the input, so temporaries are safe to pass.
-    bool parse_string(std::string_view input) const
+    // be consumed, append `!.` (EndOfFile) to the start rule. Reads `input`
+    // in place, with no copy: the Context lives only for the call, so a
+    // temporary argument outlives it.
+    bool parse_view(std::string_view input) const
     {
-        std::string s{input};
-        Context ctx{s};
+        Context ctx{input};
         return parse(ctx);
     }
 
+    // As above over a caller-kept Context: rebinds `ctx` to `input`
+    // (Context::rebind, which resets it but keeps its memory) and parses.
+    // After a few parses of similar-sized inputs this allocates nothing. The
+    // results stay readable from `ctx` until its next rebind.
+    bool parse_view(std::string_view input, Context& ctx) const
+    {
+        ctx.rebind(input);
+        return parse(ctx);
+    }
+
+    // Same as parse_view(input).
+    bool parse_string(std::string_view input) const { return parse_view(input); }
+
     // -----------------------------------------------------------------------
     // Validation helpers
     // -----------------------------------------------------------------------
@@ -428,7 +533,107 @@ public:
     }
 
 protected:
-    std::map<std::string, std::shared_ptr<NonTerminalType>> m_rules;
+    using Clock = std::chrono::steady_clock;
+
+    // Adds the time and arena nodes since construction to `phase`, if any.
+    class PhaseTimer
+    {
+    public:
+        PhaseTimer(ParsePhaseStats::Phase* phase, const Context& ctx) : m_phase{phase}, m_ctx{ctx}
+        {
+            if (m_phase) {
+                m_nodes = ctx.node_count();
+                m_start = Clock::now();
+            }
+        }
+        ~PhaseTimer()
+        {
+            if (m_phase) {
+                const auto elapsed = Clock::now() - m_start;
+                m_phase->ns += static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+                m_phase->nodes += m_ctx.node_count() - m_nodes;
+            }
+        }
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    private:
+        ParsePhaseStats::Phase* m_phase;
+        const Context& m_ctx;
+        std::size_t m_nodes = 0;
+        Clock::time_point m_start{};
+    };
+
+    std::optional<NodeType>
+    parse_ast_impl(std::string_view rule, Context& ctx, ParsePhaseStats* stats) const
+    {
+        auto it = m_rules.find(rule);
+        if (it == m_rules.end()) {
+            throw std::out_of_range{"Grammar::parse_ast: rule '" + std::string{rule} +
+                                    "' not found"};
+        }
+        auto tree = run_rule(*it->second, ctx, stats).tree;
+        if (!tree)
+            return std::nullopt;
+        std::size_t walked = 0;
+        {
+            PhaseTimer timer{stats ? &stats->on_match : nullptr, ctx};
+            walked = parsers::fire_on_match<Context, typename Context::ParseTreeNodePtr>(
+                ctx, tree, it->second);
+        }
+        if (stats) {
+            stats->on_match.nodes = walked;
+            stats->fold.nodes = walked; // the fold visits each committed node once
+        }
+        PhaseTimer timer{stats ? &stats->fold : nullptr, ctx};
+        return parsers::fold_start<Context, typename Context::ParseTreeNodePtr>(
+            ctx, tree, it->second);
+    }
+
+    // Shared body of parse / parse_tree / parse_ast: skipper, a fresh limit budget,
+    // committed-failure check, and Deferred's tracked re-parse (not after a limit stopped
+    // the parse). `stats` (parse_ast only) receives the skip and tree phases.
+    typename Context::ParseResult
+    run_rule(const NonTerminalType& rule, Context& ctx, ParsePhaseStats* stats = nullptr) const
+    {
+        ctx.internal_set_skipper(m_skipper);
+        ctx.begin_limits();
+        const std::size_t start = ctx.mark();
+        const std::size_t diagnostics_mark = ctx.diagnostics().size();
+        auto attempt = [&]() -> typename Context::ParseResult {
+            ctx.clear_committed_failure();
+            if (ctx.limit_exceeded() != LimitKind::None) {
+                return {};
+            }
+            // Pest-style leading whitespace: consume at the grammar boundary so
+            // users don't need `g["ws"] >>` prefix. Trailing whitespace is
+            // intentionally NOT consumed (partial-match); for full-input
+            // consumption append `>> !.` (EndOfFile) to the start rule.
+            {
+                PhaseTimer timer{stats ? &stats->skip : nullptr, ctx};
+                ctx.run_skipper();
+            }
+            PhaseTimer timer{stats ? &stats->tree : nullptr, ctx};
+            auto result = rule.parse(ctx);
+            // A committed failure inside the skipper is not seen by the rule.
+            if (ctx.committed_failure()) {
+                return {};
+            }
+            return result;
+        };
+        auto result = attempt();
+        if (!result.success && ctx.error_tracking() == ErrorTracking::Deferred &&
+            ctx.limit_exceeded() == LimitKind::None) {
+            ctx.prepare_diagnostic_reparse(start, diagnostics_mark);
+            result = attempt();
+            ctx.error_tracking(ErrorTracking::Deferred); // back to untracked
+        }
+        return result;
+    }
+
+    // Transparent comparator: lookups by string_view build no std::string.
+    std::map<std::string, std::shared_ptr<NonTerminalType>, std::less<>> m_rules;
     std::string m_start;
     NonTerminalType* m_skipper = nullptr;
 
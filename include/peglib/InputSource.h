@@ -1,19 +1,32 @@
 // InputSourceBase: type-erased input interface. Context holds a
 // unique_ptr<InputSourceBase<CharT>> so a single Context<CharT, NodeType>
 // can drive either a contiguous in-memory buffer (SpanSource) or a paged
-// file reader (FileSourceSource).
+// file reader (FileSourceSource / PagedFileSourceSource) or a memory-mapped
+// file (MmapSourceSource).
 //
-// SpanSource exposes a raw pointer that Context caches (m_fast_data); when
-// non-null, the per-character hot path (Context::current / Context::at)
-// indexes it with zero virtual dispatch. FileSourceSource leaves it null.
+// SpanSource and MmapSourceSource expose a raw pointer that Context caches
+// (m_fast_data); when non-null, the per-character hot path (Context::current /
+// Context::at) indexes it with zero virtual dispatch. FileSourceSource leaves
+// it null and instead publishes an InputWindow over its current page, which
+// Context checks before falling back to the virtual at().
+//
+// PushSource is the one source whose size grows after construction: bytes are
+// appended with feed() as they arrive, and close() marks the end of the
+// stream. While it is open, reaching the buffered end is "need more input",
+// not end-of-input (see Grammar::parse_async).
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <span>
 #include <string>
+#include <vector>
 
 #include "FileSource.h"
+#include "InputWindow.h"
+#include "MmapSource.h"
+#include "PagedFileSource.h"
 
 namespace peg
 {
@@ -29,28 +42,62 @@ struct InputSourceBase
     // overrides to drop pages strictly before `offset` on cut commitment.
     virtual void release_before(std::size_t /*offset*/) {}
 
+    // True while more input may still be appended (an open PushSource). Every
+    // other source is complete at construction.
+    virtual bool input_open() const noexcept { return false; }
+
+    // Pages of input the source currently holds in memory (see
+    // Context::memory_stats). Zero for sources without pages.
+    virtual std::size_t resident_pages() const noexcept { return 0; }
+
+    // Copy [offset, offset+count) into `dst`. Contiguous sources copy in one
+    // run; paged sources copy whole window runs, faulting each page in once
+    // through at() — one virtual call per page, not per item.
+    void read(std::size_t offset, std::size_t count, CharT* dst) const
+    {
+        if (m_contiguous_data != nullptr) {
+            std::copy_n(m_contiguous_data + offset, count, dst);
+            return;
+        }
+        while (count != 0) {
+            const InputWindow<CharT>& w = *m_window;
+            if (w.contains(offset)) {
+                const std::size_t n = std::min(count, w.end - offset);
+                std::copy_n(w.data + (offset - w.begin), n, dst);
+                offset += n;
+                dst += n;
+                count -= n;
+            } else {
+                *dst++ = this->at(offset++);
+                --count;
+            }
+        }
+    }
+
     // Slice [offset, offset+count). Constrained to integral CharT:
     // basic_string<CharT> is ill-formed for non-trivially-copyable CharT, so
     // token-level grammars have no slicing API (read payloads via ctx.at).
     std::basic_string<CharT> slice(std::size_t offset, std::size_t count) const
         requires std::is_integral_v<CharT>
     {
-        if (m_contiguous_data != nullptr) {
-            return std::basic_string<CharT>{m_contiguous_data + offset, count};
-        }
-        std::basic_string<CharT> out;
-        out.reserve(count);
-        for (std::size_t i = 0; i < count; ++i) {
-            out.push_back(this->at(offset + i));
-        }
+        std::basic_string<CharT> out(count, CharT{});
+        read(offset, count, out.data());
         return out;
     }
 
     // Raw pointer to contiguous storage, or nullptr if the source is paged.
     const CharT* contiguous_data() const noexcept { return m_contiguous_data; }
 
+    // The paged source's current window. Stable for the source's lifetime
+    // (Context caches the pointer); its contents change as pages fault in.
+    // Sources without pages return a permanently empty window.
+    const InputWindow<CharT>* window() const noexcept { return m_window; }
+
 protected:
+    static constexpr InputWindow<CharT> s_no_window{};
+
     const CharT* m_contiguous_data = nullptr;
+    const InputWindow<CharT>* m_window = &s_no_window;
 };
 
 // Adapter for contiguous in-memory ranges (std::string, std::vector, span).
@@ -66,22 +113,61 @@ struct SpanSource : InputSourceBase<CharT>
     CharT at(std::size_t offset) const override { return m_data[offset]; }
     std::size_t size() const override { return m_size; }
 
+    // Point at another range (Context::rebind).
+    void rebind(const CharT* data, std::size_t size) noexcept
+    {
+        m_data = data;
+        m_size = size;
+        this->m_contiguous_data = data;
+    }
+
 private:
     const CharT* m_data;
     std::size_t m_size;
 };
 
+// Growable in-memory source for push-style input (network streams). Owns its
+// buffer; feed() appends and may reallocate, so the contiguous pointer is
+// re-published after each append and Context re-reads it (Context::feed).
+template<typename CharT>
+struct PushSource : InputSourceBase<CharT>
+{
+    PushSource() = default;
+
+    CharT at(std::size_t offset) const override { return m_buf[offset]; }
+    std::size_t size() const override { return m_buf.size(); }
+    bool input_open() const noexcept override { return !m_closed; }
+
+    void feed(std::span<const CharT> data)
+    {
+        m_buf.insert(m_buf.end(), data.begin(), data.end());
+        this->m_contiguous_data = m_buf.data();
+    }
+
+    // End of stream: no further feed() is expected, and reaching the buffered
+    // end is a genuine end-of-input again.
+    void close() noexcept { m_closed = true; }
+
+private:
+    std::vector<CharT> m_buf;
+    bool m_closed = false;
+};
+
 // Adapter for FileSource. Owns the FileSource by move; forwards cut-driven
 // eviction via release_before.
 template<typename CharT, std::size_t PageSize>
 struct FileSourceSource : InputSourceBase<CharT>
 {
-    explicit FileSourceSource(FileSource<CharT, PageSize>&& fs) : m_fs{std::move(fs)} {}
+    explicit FileSourceSource(FileSource<CharT, PageSize>&& fs) : m_fs{std::move(fs)}
+    {
+        this->m_window = &m_fs.window();
+    }
 
     CharT at(std::size_t offset) const override { return m_fs.at(offset); }
     std::size_t size() const override { return m_fs.size(); }
 
     void release_before(std::size_t offset) override { m_fs.release_before(offset); }
+    std::size_t resident_pages() const noexcept override { return m_fs.resident_pages(); }
 
     // Exposed for SourceMap, which walks the file directly.
     const FileSource<CharT, PageSize>& file_source() const noexcept { return m_fs; }
@@ -90,4 +176,48 @@ private:
     FileSource<CharT, PageSize> m_fs;
 };
 
+// Adapter for PagedFileSource: the N-page LRU cache, forwarded like
+// FileSourceSource.
+template<typename CharT>
+struct PagedFileSourceSource : InputSourceBase<CharT>
+{
+    explicit PagedFileSourceSource(PagedFileSource<CharT>&& ps) : m_ps{std::move(ps)}
+    {
+        this->m_window = &m_ps.window();
+    }
+
+    CharT at(std::size_t offset) const override { return m_ps.at(offset); }
+    std::size_t size() const override { return m_ps.size(); }
+
+    void release_before(std::size_t offset) override { m_ps.release_before(offset); }
+    std::size_t resident_pages() const noexcept override { return m_ps.resident_pages(); }
+
+    const PagedFileSource<CharT>& paged_file_source() const noexcept { return m_ps; }
+
+private:
+    PagedFileSource<CharT> m_ps;
+};
+
+// Adapter for MmapSource. Owns the mapping by move and publishes it as
+// contiguous data, so the Context hot path never dispatches through here;
+// release_before forwards cut commitment to the page-release hint.
+template<typename CharT>
+struct MmapSourceSource : InputSourceBase<CharT>
+{
+    explicit MmapSourceSource(MmapSource<CharT>&& ms) : m_ms{std::move(ms)}
+    {
+        this->m_contiguous_data = m_ms.data();
+    }
+
+    CharT at(std::size_t offset) const override { return m_ms.at(offset); }
+    std::size_t size() const override { return m_ms.size(); }
+
+    void release_before(std::size_t offset) override { m_ms.release_before(offset); }
+
+    const MmapSource<CharT>& mmap_source() const noexcept { return m_ms; }
+
+private:
+    MmapSource<CharT> m_ms;
+};
+
 } // namespace peg
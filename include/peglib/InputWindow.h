@@ -0,0 +1,30 @@
+// InputWindow: the contiguous run of input a paged source currently holds in
+// memory, published so Context can index it without a virtual call.
+//
+// A paged source owns one InputWindow and rewrites it whenever the page it
+// last served changes (refill, buffer switch, eviction). Context keeps a
+// pointer to it and resolves an access as: contiguous pointer, else
+// `offset - begin < end - begin` against the window, else the virtual at()
+// — which faults the page in and moves the window. An empty window
+// (begin == end) never matches.
+#pragma once
+#include <cstddef>
+
+namespace peg
+{
+
+template<typename CharT>
+struct InputWindow
+{
+    const CharT* data = nullptr; // item at offset `begin`
+    std::size_t begin = 0;
+    std::size_t end = 0; // exclusive
+
+    [[nodiscard]] bool contains(std::size_t offset) const noexcept
+    {
+        // Unsigned wrap folds `offset >= begin && offset < end` into one compare.
+        return offset - begin < end - begin;
+    }
+};
+
+} // namespace peg
@@ -0,0 +1,285 @@
+// MemoTable: the packrat memo, stored in position order.
+//
+// The entries for one input position live in one slot, a short vector of
+// (rule, answer) pairs searched linearly: a position holds a handful of
+// rules in practice (about five in the Lua grammar), which a scan finds
+// faster than a hash. Slots are grouped into blocks of `block_size`
+// consecutive positions, and the blocks are kept in position order. A
+// lookup is a division and two indexings, with no hash of the position.
+// Releasing everything before a cut (Context::remove_cut) drops whole
+// blocks off the front and clears the leading part of the next one. A
+// release therefore costs what it frees, not a scan of the whole memo. With
+// a cut per list element, the scan made every commit O(memo) and the parse
+// O(n²).
+//
+// Released blocks are not freed: their slots are cleared (keeping their
+// capacity) and the block goes on a spare list, which slot() draws from
+// before allocating. clear() does the same for every block, so a memo that
+// is cleared and refilled to a similar size allocates nothing. A block the
+// parse never touched (a gap left by a recovery scan) stays a null pointer.
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace peg
+{
+
+template<typename Key, typename Value>
+class MemoTable
+{
+public:
+    // The entries at one position. Unordered: erase() moves the last entry
+    // into the erased one's place.
+    class Slot
+    {
+    public:
+        using value_type = std::pair<Key, Value>;
+        using iterator = typename std::vector<value_type>::iterator;
+        using const_iterator = typename std::vector<value_type>::const_iterator;
+
+        [[nodiscard]] iterator find(const Key& key) noexcept
+        {
+            return std::find_if(
+                m_items.begin(), m_items.end(), [&key](const auto& i) { return i.first == key; });
+        }
+        [[nodiscard]] const_iterator find(const Key& key) const noexcept
+        {
+            return std::find_if(
+                m_items.begin(), m_items.end(), [&key](const auto& i) { return i.first == key; });
+        }
+
+        // The entry for `key`, value-initialized if new; true if it is new.
+        std::pair<iterator, bool> try_emplace(const Key& key)
+        {
+            if (auto it = find(key); it != m_items.end()) {
+                return {it, false};
+            }
+            m_items.emplace_back(
+                std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+            return {std::prev(m_items.end()), true};
+        }
+
+        // Returns the iterator to visit next: `it` again (now holding the
+        // entry that was last), or end().
+        iterator erase(iterator it)
+        {
+            if (it != std::prev(m_items.end())) {
+                *it = std::move(m_items.back());
+            }
+            m_items.pop_back();
+            return it;
+        }
+
+        template<typename Pred>
+        std::size_t erase_if(Pred pred)
+        {
+            return std::erase_if(m_items, pred);
+        }
+
+        void clear() noexcept { m_items.clear(); }
+        [[nodiscard]] bool empty() const noexcept { return m_items.empty(); }
+        [[nodiscard]] std::size_t size() const noexcept { return m_items.size(); }
+        [[nodiscard]] std::size_t capacity() const noexcept { return m_items.capacity(); }
+        [[nodiscard]] iterator begin() noexcept { return m_items.begin(); }
+        [[nodiscard]] iterator end() noexcept { return m_items.end(); }
+        [[nodiscard]] const_iterator begin() const noexcept { return m_items.begin(); }
+        [[nodiscard]] const_iterator end() const noexcept { return m_items.end(); }
+
+    private:
+        std::vector<value_type> m_items;
+    };
+
+    static constexpr std::size_t block_size = 64;
+
+    // The slot for `pos`, or null if its block does not exist. An existing
+    // slot may be empty.
+    [[nodiscard]] Slot* find(std::size_t pos) noexcept
+    {
+        Block* block = block_at(pos / block_size);
+        return block ? &block->slots[pos % block_size] : nullptr;
+    }
+    [[nodiscard]] const Slot* find(std::size_t pos) const noexcept
+    {
+        const Block* block = block_at(pos / block_size);
+        return block ? &block->slots[pos % block_size] : nullptr;
+    }
+
+    // The slot for `pos`. Creates its block if needed, in front of the
+    // others when the parse rewound below a released position.
+    Slot& slot(std::size_t pos)
+    {
+        const std::size_t b = pos / block_size;
+        const std::size_t live = m_blocks.size() - m_head;
+        if (live == 0) {
+            m_blocks.clear();
+            m_head = 0;
+            m_first = b;
+            m_blocks.emplace_back();
+        } else if (b < m_first) {
+            const std::size_t n = m_first - b;
+            if (n > m_head) {
+                const std::size_t grow = n - m_head;
+                m_blocks.resize(m_blocks.size() + grow);
+                std::move_backward(m_blocks.begin(), m_blocks.end() - grow, m_blocks.end());
+                m_head += grow;
+            }
+            m_head -= n;
+            m_first = b;
+        } else if (b - m_first >= live) {
+            m_blocks.resize(m_head + (b - m_first) + 1);
+        }
+        std::unique_ptr<Block>& block = m_blocks[m_head + (b - m_first)];
+        if (!block) {
+            if (m_spare.empty()) {
+                block = std::make_unique<Block>();
+            } else {
+                block = std::move(m_spare.back());
+                m_spare.pop_back();
+            }
+            ++m_allocated;
+        }
+        m_released = std::min(m_released, pos);
+        return block->slots[pos % block_size];
+    }
+
+    // Drop every entry at a position before `pos`, and return how many were
+    // dropped. Positions already released by an earlier call are not
+    // visited again.
+    std::size_t release_before(std::size_t pos)
+    {
+        std::size_t released = 0;
+        const std::size_t b = pos / block_size;
+        while (m_head < m_blocks.size() && m_first < b) {
+            released += recycle(m_blocks[m_head]);
+            ++m_head;
+            ++m_first;
+        }
+        // Compact once the dropped prefix outgrows the live part: each
+        // block is moved at most once per drop, and capacity is kept.
+        if (m_head * 2 > m_blocks.size()) {
+            const auto head = static_cast<std::ptrdiff_t>(m_head);
+            m_blocks.erase(m_blocks.begin(), m_blocks.begin() + head);
+            m_head = 0;
+        }
+        if (m_head < m_blocks.size() && m_first == b && m_blocks[m_head]) {
+            Block& block = *m_blocks[m_head];
+            for (std::size_t p = std::max(m_released, b * block_size); p < pos; ++p) {
+                Slot& s = block.slots[p % block_size];
+                released += s.size();
+                s.clear();
+            }
+        }
+        m_released = std::max(m_released, pos);
+        return released;
+    }
+
+    // Drop every entry. The blocks, and their slots' capacity, are kept
+    // for reuse.
+    void clear()
+    {
+        for (std::size_t i = m_head; i < m_blocks.size(); ++i) {
+            recycle(m_blocks[i]);
+        }
+        m_blocks.clear();
+        m_head = 0;
+        m_first = 0;
+        m_allocated = 0;
+        m_released = 0;
+    }
+
+    // `f(pos, slot)` for every non-empty slot, in position order.
+    template<typename F>
+    void for_each(F f)
+    {
+        visit(*this, f);
+    }
+    template<typename F>
+    void for_each(F f) const
+    {
+        visit(*this, f);
+    }
+
+    // Blocks in use, blocks kept for reuse, and the bytes each one takes
+    // (without its slots' entries).
+    [[nodiscard]] std::size_t block_count() const noexcept { return m_allocated; }
+    [[nodiscard]] std::size_t spare_block_count() const noexcept { return m_spare.size(); }
+    static constexpr std::size_t block_bytes = block_size * sizeof(Slot);
+
+    // Entry capacity of every slot, in use or spare. Walks the blocks.
+    [[nodiscard]] std::size_t entry_capacity() const noexcept
+    {
+        std::size_t n = 0;
+        auto add = [&n](const std::unique_ptr<Block>& block) {
+            if (block) {
+                for (const Slot& s : block->slots) {
+                    n += s.capacity();
+                }
+            }
+        };
+        std::for_each(m_blocks.begin() + static_cast<std::ptrdiff_t>(m_head), m_blocks.end(), add);
+        std::for_each(m_spare.begin(), m_spare.end(), add);
+        return n;
+    }
+
+private:
+    struct Block
+    {
+        std::array<Slot, block_size> slots;
+    };
+
+    Block* block_at(std::size_t b) const noexcept
+    {
+        if (b < m_first || b - m_first >= m_blocks.size() - m_head) {
+            return nullptr;
+        }
+        return m_blocks[m_head + (b - m_first)].get();
+    }
+
+    // Clear `block` onto the spare list; returns the entries it held.
+    std::size_t recycle(std::unique_ptr<Block>& block)
+    {
+        if (!block) {
+            return 0;
+        }
+        std::size_t entries = 0;
+        for (Slot& s : block->slots) {
+            entries += s.size();
+            s.clear();
+        }
+        m_spare.push_back(std::move(block));
+        --m_allocated;
+        return entries;
+    }
+
+    template<typename Self, typename F>
+    static void visit(Self& self, F& f)
+    {
+        for (std::size_t i = self.m_head; i < self.m_blocks.size(); ++i) {
+            if (!self.m_blocks[i]) {
+                continue;
+            }
+            auto& slots = self.m_blocks[i]->slots;
+            for (std::size_t j = 0; j < block_size; ++j) {
+                if (!slots[j].empty()) {
+                    f((self.m_first + i - self.m_head) * block_size + j, slots[j]);
+                }
+            }
+        }
+    }
+
+    // m_blocks[m_head] is block number m_first; the entries before m_head
+    // were released (null) and are dropped by the next compaction.
+    std::vector<std::unique_ptr<Block>> m_blocks;
+    std::size_t m_head = 0;
+    std::size_t m_first = 0;
+    std::size_t m_allocated = 0; // non-null blocks in use
+    std::size_t m_released = 0;  // every slot before it is empty
+    std::vector<std::unique_ptr<Block>> m_spare;
+};
+
+} // namespace peg
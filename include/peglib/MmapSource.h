@@ -0,0 +1,178 @@
+// Memory-mapped, read-only file input source.
+//
+// The whole file is mapped once; the mapping IS the buffer, so Context indexes
+// it directly through the contiguous-data fast path (m_fast_data) with zero
+// virtual dispatch and no copy into a std::string. Suitable for any file that
+// fits in the address space; use FileSource for bounded-memory paging on
+// platforms without mmap or for files larger than the address space.
+//
+// All sizes are in ITEMS (number of value_type elements), not bytes. A
+// trailing partial item (file size not a multiple of sizeof(value_type)) is
+// not addressable, mirroring FileSource.
+//
+// Paging hints (POSIX): the mapping is advised MADV_SEQUENTIAL (the parser
+// reads mostly forward), and release_before() advises MADV_DONTNEED on the
+// whole pages strictly before the cut position, so resident memory tracks the
+// live window instead of the file size. The mapping is private and read-only:
+// a released page is simply re-faulted from the file if a later access (e.g.
+// a post-parse fold reading an early offset) touches it again — eviction is
+// transparent, as with FileSource.
+//
+// Thread safety: the mapping is immutable; concurrent reads are safe.
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace peg
+{
+
+template<typename value_type_>
+struct MmapSource
+{
+    using value_type = value_type_;
+
+    explicit MmapSource(const std::string& path)
+    {
+#if defined(_WIN32)
+        HANDLE file = ::CreateFileA(path.c_str(),
+                                    GENERIC_READ,
+                                    FILE_SHARE_READ,
+                                    nullptr,
+                                    OPEN_EXISTING,
+                                    FILE_FLAG_SEQUENTIAL_SCAN,
+                                    nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("MmapSource: failed to open '" + path + "'");
+        }
+        LARGE_INTEGER bytes{};
+        if (!::GetFileSizeEx(file, &bytes)) {
+            ::CloseHandle(file);
+            throw std::runtime_error("MmapSource: failed to stat '" + path + "'");
+        }
+        m_bytes = static_cast<std::size_t>(bytes.QuadPart);
+        if (m_bytes > 0) {
+            HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                m_base = ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                ::CloseHandle(mapping);
+            }
+            if (m_base == nullptr) {
+                ::CloseHandle(file);
+                throw std::runtime_error("MmapSource: failed to map '" + path + "'");
+            }
+        }
+        ::CloseHandle(file);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("MmapSource: failed to open '" + path + "'");
+        }
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("MmapSource: failed to stat '" + path + "'");
+        }
+        m_bytes = static_cast<std::size_t>(st.st_size);
+        // mmap of length 0 is EINVAL; an empty file is an empty source with a
+        // null base (never dereferenced — every access is past the end).
+        if (m_bytes > 0) {
+            void* p = ::mmap(nullptr, m_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("MmapSource: failed to map '" + path + "'");
+            }
+            m_base = p;
+            ::madvise(m_base, m_bytes, MADV_SEQUENTIAL);
+        }
+        // The mapping holds its own reference to the file.
+        ::close(fd);
+#endif
+        m_size = m_bytes / sizeof(value_type);
+    }
+
+    MmapSource(const MmapSource&) = delete;
+    MmapSource& operator=(const MmapSource&) = delete;
+
+    MmapSource(MmapSource&& rhs) noexcept
+        : m_base{rhs.m_base}, m_bytes{rhs.m_bytes}, m_size{rhs.m_size},
+          m_released_to{rhs.m_released_to}
+    {
+        rhs.m_base = nullptr;
+        rhs.m_bytes = 0;
+        rhs.m_size = 0;
+        rhs.m_released_to = 0;
+    }
+
+    MmapSource& operator=(MmapSource&&) = delete;
+
+    ~MmapSource()
+    {
+        if (m_base == nullptr) {
+            return;
+        }
+#if defined(_WIN32)
+        ::UnmapViewOfFile(m_base);
+#else
+        ::munmap(m_base, m_bytes);
+#endif
+    }
+
+    // Raw pointer to the mapped items (nullptr for an empty file).
+    const value_type* data() const noexcept { return static_cast<const value_type*>(m_base); }
+    std::size_t size() const noexcept { return m_size; }
+
+    // Item at position `pos`. Calling with `pos >= size()` is undefined.
+    value_type at(std::size_t pos) const { return data()[pos]; }
+
+    std::basic_string_view<value_type> view() const noexcept
+        requires std::is_integral_v<value_type>
+    {
+        return {data(), m_size};
+    }
+
+    // Drop the resident pages strictly before item `pos` (cut commitment).
+    // Only whole pages are released, and each page at most once.
+    void release_before(std::size_t pos)
+    {
+#if defined(_WIN32)
+        (void)pos;
+#else
+        static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t byte_pos = (pos < m_size ? pos : m_size) * sizeof(value_type);
+        const std::size_t release_to = byte_pos - (byte_pos % page);
+        if (release_to <= m_released_to) {
+            return;
+        }
+        ::madvise(static_cast<char*>(m_base) + m_released_to,
+                  release_to - m_released_to,
+                  MADV_DONTNEED);
+        m_released_to = release_to;
+#endif
+    }
+
+private:
+    void* m_base = nullptr;
+    std::size_t m_bytes = 0;
+    std::size_t m_size = 0;
+    std::size_t m_released_to = 0; // bytes, page-aligned
+};
+
+} // namespace peg
@@ -58,10 +58,18 @@ public:
         return *this;
     }
 
-    void set_name(std::string name) { m_name = std::move(name); }
+    void set_name(std::string name)
+    {
+        m_name = std::move(name);
+        update_expected();
+    }
     [[nodiscard]] const std::string& name() const noexcept { return m_name; }
 
-    void set_label(std::string label) { m_label = std::move(label); }
+    void set_label(std::string label)
+    {
+        m_label = std::move(label);
+        update_expected();
+    }
     [[nodiscard]] const std::string& label() const noexcept { return m_label; }
 
     // Configure recovery. On body failure (with no cut committed at the
@@ -83,6 +91,60 @@ public:
     void clear_body_for_debug() noexcept { m_rule.reset(); }
 
     ParseResult parse(Context& context) const override
+    {
+        // Profiling and limits are both off: one test.
+        if (context.rule_hooks()) [[unlikely]] {
+            return parseHooked(context);
+        }
+        return parseRule(context);
+    }
+
+    void collect_rule_refs(std::set<std::string>& refs) const override
+    {
+        if (m_rule)
+            m_rule->collect_rule_refs(refs);
+    }
+
+    // One level of height over the body; solved across the rule graph by
+    // Generator::rule_cost.
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        using Gen = Generator<typename Context::value_type>;
+        return gen.rule_cost(this, [this](Gen& g) {
+            return m_rule ? m_rule->generate_cost(g) : Gen::unbounded;
+        });
+    }
+
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        if (!m_rule) {
+            return false;
+        }
+        gen.enter_rule(m_name);
+        const bool ok = m_rule->generate(gen);
+        gen.leave_rule();
+        return ok;
+    }
+
+protected:
+    // parse() with the Context's limits charged and its profiler told.
+    ParseResult parseHooked(Context& context) const
+    {
+        if (!context.limit_enter()) {
+            return ParseResult{false, nullptr};
+        }
+        ScopeGuard leave_limits{[&context] { context.limit_leave(); }};
+        if (RuleProfiler* profiler = context.profiler()) {
+            profiler->enter(this, m_name);
+            ScopeGuard leave{[profiler] { profiler->leave(); }};
+            return parseRule(context);
+        }
+        return parseRule(context);
+    }
+
+    // Memo lookup, left-recursion detection, then the body (parseImpl),
+    // failure recording and recovery, and the rule's tree node.
+    ParseResult parseRule(Context& context) const
     {
         auto start_pos = context.mark();
         auto [ok, rule_state] = context.rule_state(this, start_pos);
@@ -102,6 +164,8 @@ public:
                     }
                 }
                 auto seed = context.memo_get(this, start_pos);
+                if (seed.m_touched_end)
+                    context.note_end_reached();
                 context.reset(seed.m_last_pos);
                 return seed.m_cached_result;
             }
@@ -111,11 +175,16 @@ public:
             const auto* head = context.growing_head(start_pos);
             if (head != nullptr && head != this) {
                 auto seed = context.memo_get(this, start_pos);
+                if (seed.m_touched_end)
+                    context.note_end_reached();
                 context.reset(seed.m_last_pos);
                 return seed.m_cached_result;
             }
 
-            // (c) Ordinary memo hit.
+            // (c) Ordinary memo hit. Replaying an answer that depended on the
+            // end of input makes the caller depend on it too.
+            if (rule_state.m_touched_end)
+                context.note_end_reached();
             context.reset(rule_state.m_last_pos);
             return rule_state.m_cached_result;
         }
@@ -125,28 +194,36 @@ public:
         typename Context::LRFrame frame{this, start_pos, start_pos, false, context.lr_top()};
         context.lr_push(&frame);
 
+        const std::size_t end_hits = context.end_hits();
         auto inner = parseImpl(context, start_pos, rule_state, frame);
 
         context.lr_pop(&frame);
+        rule_state.m_touched_end = context.end_hits() != end_hits;
 
         if (frame.is_head) {
             context.clear_growing_head(start_pos);
         }
 
+        // Committed failure on its way out: no expected item for this rule
+        // and no recovery. The memo keeps the planted failure seed, stamped
+        // with whether it reached the end of input: a cut at this rule's own
+        // position does not release the seed, so prepare_resume() must see
+        // that it depends on input that has not arrived yet.
+        if (context.committed_failure()) {
+            auto seed = context.memo_get(this, start_pos);
+            seed.m_touched_end = rule_state.m_touched_end;
+            context.update_rule_state(this, start_pos, seed);
+            return ParseResult{false, nullptr};
+        }
+
         if (!inner.success) {
-            if (!m_label.empty()) {
-                context.record_failure(
-                    start_pos, ExpectedItem{.kind = ExpectedKind::RuleLabel, .text = m_label});
-            } else if (!m_name.empty()) {
-                context.record_failure(
-                    start_pos, ExpectedItem{.kind = ExpectedKind::RuleName, .text = m_name});
+            // Prebuilt (update_expected): recording it is a pointer push.
+            if (!m_label.empty() || !m_name.empty()) {
+                context.record_failure(start_pos, m_expected);
             }
             // Recovery: cut-committed failures are NOT recovered.
             if (m_recover.configured() && !context.cut()) {
-                std::size_t scan = start_pos;
-                while (scan < context.input_size() && !m_recover.is_sync_token(context.at(scan))) {
-                    ++scan;
-                }
+                const std::size_t scan = m_recover.find_sync(context, start_pos);
                 std::size_t resume_at =
                     (scan < context.input_size()) ? scan + 1 : context.input_size();
                 context.reset(resume_at);
@@ -154,6 +231,9 @@ public:
                     Diagnostic{start_pos,
                                {ExpectedItem{ExpectedKind::RuleLabel,
                                              m_recover.label.empty() ? m_name : m_recover.label}}});
+                rule_state.m_touched_end = context.end_hits() != end_hits;
+                if (rule_state.m_touched_end)
+                    context.mark_last_diagnostic_provisional();
                 ParseResult recovered{true, nullptr};
                 rule_state.m_cached_result = recovered;
                 rule_state.m_last_pos = resume_at;
@@ -198,13 +278,6 @@ public:
         return result;
     }
 
-    void collect_rule_refs(std::set<std::string>& refs) const override
-    {
-        if (m_rule)
-            m_rule->collect_rule_refs(refs);
-    }
-
-protected:
     // Seed-grow loop (Warth §3.2). For an ordinary rule the first iteration
     // matches and the second makes no progress (and breaks). For a
     // left-recursive head (frame.is_head), each growth iteration also clears
@@ -231,6 +304,9 @@ protected:
                 context.clear_siblings_at(start_pos, this);
             }
             auto result = m_rule->parse(context);
+            if (context.committed_failure()) {
+                return ParseResult{false, nullptr};
+            }
             auto end_pos = context.mark();
             if (result.success) {
                 if (end_pos > frame.last_pos) {
@@ -265,10 +341,20 @@ protected:
         return best;
     }
 
+    // The expected item for this rule's failure: its label if it has one,
+    // else its name.
+    void update_expected()
+    {
+        m_expected = std::make_shared<const ExpectedItem>(
+            m_label.empty() ? ExpectedItem{.kind = ExpectedKind::RuleName, .text = m_name}
+                            : ExpectedItem{.kind = ExpectedKind::RuleLabel, .text = m_label});
+    }
+
 protected:
     std::shared_ptr<ParsingExprInterface<Context>> m_rule;
     std::string m_name;
     std::string m_label;
+    SharedExpectedItem m_expected;
     RecoverSpec<typename Context::value_type> m_recover;
     TypedFold m_typed_fold;
     OnMatch m_on_match;
@@ -351,6 +437,15 @@ struct Rule : ParsingExpr<Context, Rule<Context>>
 
     void collect_rule_refs(std::set<std::string>& refs) const override { refs.insert(m_name); }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>& gen) const override
+    {
+        return m_impl->generate_cost(gen);
+    }
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        return m_impl->generate(gen);
+    }
+
     [[nodiscard]] const std::string& name() const noexcept { return m_name; }
     [[nodiscard]] const std::string& label() const noexcept { return m_impl->label(); }
     [[nodiscard]] bool is_defined() const noexcept { return m_impl->is_defined(); }
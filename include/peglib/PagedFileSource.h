@@ -0,0 +1,344 @@
+// Paged, LRU-cached file-backed input source with runtime page sizing.
+//
+// FileSource keeps exactly two compile-time pages, so any backtrack further
+// than one page behind the read head forces a synchronous seek + read that
+// throws the current page away. PagedFileSource keeps `page_count` resident
+// pages of `page_size` items each (both chosen at run time) and evicts the
+// least-recently-used one on a miss. Pages wholly before a release_before()
+// position are dropped first, so cut commitment frees slots ahead of LRU.
+//
+// Read-ahead (optional): a background thread with its own FILE* prefetches
+// the page following each newly faulted page into a staging buffer. A later
+// miss on that page takes the staged buffer by pointer swap instead of
+// reading synchronously (waiting for the in-flight read if necessary), so a
+// forward scan overlaps parsing with I/O. One page is staged at a time —
+// parsing is sequential, and a deeper queue only pays off when a single page
+// parses faster than it reads.
+//
+// Window: the page that served the last fault is published as an
+// InputWindow (see InputWindow.h), so Context indexes it directly and only
+// page crossings dispatch through at().
+//
+// All internal sizes are in ITEMS (number of value_type elements), not bytes.
+//
+// Thread safety: like FileSource, NOT thread-safe for concurrent readers —
+// the page cache is mutated by const accessors. The read-ahead thread only
+// touches its own FILE* and staging buffer, under the prefetcher's mutex.
+//
+// Large files: fseek uses a `long` offset (see FileSource.h).
+#pragma once
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "InputWindow.h"
+
+namespace peg
+{
+
+struct PagedFileOptions
+{
+    std::size_t page_size = 4096; // items per page
+    std::size_t page_count = 8;   // resident pages
+    bool read_ahead = false;      // background prefetch of the next page
+};
+
+// Page-load counters, for tuning page_size / page_count.
+struct PagedFileStats
+{
+    std::size_t disk_reads = 0; // pages read synchronously on a miss
+    std::size_t prefetched = 0; // misses served from the read-ahead buffer
+};
+
+template<typename value_type_>
+class PagedFileSource
+{
+public:
+    using value_type = value_type_;
+
+    explicit PagedFileSource(const std::string& path, PagedFileOptions options = {})
+        : m_options{options}
+    {
+        if (m_options.page_size == 0 || m_options.page_count == 0) {
+            throw std::invalid_argument(
+                "PagedFileSource: page_size and page_count must be positive");
+        }
+        m_fp = std::fopen(path.c_str(), "rb");
+        if (m_fp == nullptr) {
+            throw std::runtime_error("PagedFileSource: failed to open '" + path + "'");
+        }
+        try {
+            m_filesize = std::filesystem::file_size(path) / sizeof(value_type);
+            m_pages.resize(m_options.page_count);
+            for (auto& page : m_pages) {
+                page.data = std::make_unique<value_type[]>(m_options.page_size);
+            }
+            if (m_options.read_ahead) {
+                m_prefetch = std::make_unique<Prefetcher>(path, m_options.page_size);
+            }
+        } catch (...) {
+            std::fclose(m_fp);
+            m_fp = nullptr;
+            throw;
+        }
+    }
+
+    PagedFileSource(const PagedFileSource&) = delete;
+    PagedFileSource& operator=(const PagedFileSource&) = delete;
+
+    // Pages live behind unique_ptrs and the prefetcher on the heap, so moving
+    // the vector / pointer keeps m_last and the worker's state valid.
+    PagedFileSource(PagedFileSource&& rhs) noexcept
+        : m_options{rhs.m_options}, m_filesize{rhs.m_filesize}, m_pages{std::move(rhs.m_pages)},
+          m_last{rhs.m_last}, m_window{rhs.m_window}, m_tick{rhs.m_tick}, m_stats{rhs.m_stats},
+          m_fp{rhs.m_fp}, m_prefetch{std::move(rhs.m_prefetch)}
+    {
+        rhs.m_fp = nullptr;
+        rhs.m_last = nullptr;
+        rhs.m_window = {};
+        rhs.m_filesize = 0;
+    }
+
+    PagedFileSource& operator=(PagedFileSource&&) = delete;
+
+    ~PagedFileSource()
+    {
+        m_prefetch.reset(); // join the worker before closing anything
+        if (m_fp) {
+            std::fclose(m_fp);
+        }
+    }
+
+    // Item at position `pos`. Calling with `pos >= size()` is undefined.
+    value_type at(std::size_t pos) const
+    {
+        assert(pos < m_filesize && "PagedFileSource::at: position out of range");
+        const Page* p = m_last;
+        // Unsigned wrap folds `pos >= from && pos < from + count` into one compare.
+        if (p != nullptr && pos - p->from < p->count) {
+            return p->data[pos - p->from];
+        }
+        return fault(pos);
+    }
+
+    std::size_t size() const noexcept { return m_filesize; }
+
+    // Drop resident pages that end at or before `pos`; their slots are reused
+    // before any LRU eviction. Later reads below `pos` re-fault transparently.
+    void release_before(std::size_t pos)
+    {
+        for (auto& page : m_pages) {
+            if (page.count != 0 && page.from + page.count <= pos) {
+                if (m_last == &page) {
+                    m_last = nullptr;
+                    m_window = {};
+                }
+                page.count = 0;
+            }
+        }
+    }
+
+    const InputWindow<value_type>& window() const noexcept { return m_window; }
+    const PagedFileOptions& options() const noexcept { return m_options; }
+    const PagedFileStats& stats() const noexcept { return m_stats; }
+
+    // Number of pages currently holding data.
+    std::size_t resident_pages() const noexcept
+    {
+        std::size_t n = 0;
+        for (const auto& page : m_pages) {
+            n += page.count != 0 ? 1 : 0;
+        }
+        return n;
+    }
+
+private:
+    struct Page
+    {
+        std::unique_ptr<value_type[]> data;
+        std::size_t from = 0;
+        std::size_t count = 0; // 0 = empty slot
+        std::uint64_t last_use = 0;
+    };
+
+    // Background reader. Owns a second FILE* so it never contends with the
+    // synchronous path's seek position.
+    struct Prefetcher
+    {
+        static constexpr std::size_t none = static_cast<std::size_t>(-1);
+
+        Prefetcher(const std::string& path, std::size_t page_size)
+            : page_size{page_size}, buf{std::make_unique<value_type[]>(page_size)}
+        {
+            fp = std::fopen(path.c_str(), "rb");
+            if (fp == nullptr) {
+                throw std::runtime_error("PagedFileSource: failed to open '" + path + "'");
+            }
+            worker = std::thread([this] { loop(); });
+        }
+
+        Prefetcher(const Prefetcher&) = delete;
+        Prefetcher& operator=(const Prefetcher&) = delete;
+
+        ~Prefetcher()
+        {
+            {
+                std::lock_guard lock{mu};
+                stop = true;
+            }
+            cv.notify_all();
+            worker.join();
+            std::fclose(fp);
+        }
+
+        // Queue `page_no` unless it is already staged or being read. A newer
+        // request replaces an older one that has not started yet.
+        void request(std::size_t page_no)
+        {
+            {
+                std::lock_guard lock{mu};
+                if (ready == page_no || inflight == page_no) {
+                    return;
+                }
+                requested = page_no;
+            }
+            cv.notify_all();
+        }
+
+        // If `page_no` is staged (or queued / in flight — then wait for it),
+        // swap the staged buffer into `dst` and return its item count.
+        // Returns 0 when the page was never requested.
+        std::size_t take(std::size_t page_no, std::unique_ptr<value_type[]>& dst)
+        {
+            std::unique_lock lock{mu};
+            cv.wait(lock, [&] { return requested != page_no && inflight != page_no; });
+            if (ready != page_no) {
+                return 0;
+            }
+            std::swap(dst, buf);
+            ready = none;
+            return ready_count;
+        }
+
+        void loop()
+        {
+            std::unique_lock lock{mu};
+            for (;;) {
+                cv.wait(lock, [&] { return stop || requested != none; });
+                if (stop) {
+                    return;
+                }
+                inflight = requested;
+                requested = none;
+                ready = none;
+                lock.unlock();
+                // buf is ours while inflight is set: take() never swaps it then.
+                std::size_t n = 0;
+                if (std::fseek(fp, static_cast<long>(inflight * page_size * sizeof(value_type)),
+                               SEEK_SET) == 0) {
+                    n = std::fread(buf.get(), sizeof(value_type), page_size, fp);
+                }
+                lock.lock();
+                ready = inflight;
+                ready_count = n;
+                inflight = none;
+                cv.notify_all();
+            }
+        }
+
+        std::size_t page_size;
+        std::unique_ptr<value_type[]> buf;
+        FILE* fp = nullptr;
+        std::mutex mu;
+        std::condition_variable cv;
+        std::size_t requested = none;
+        std::size_t inflight = none;
+        std::size_t ready = none;
+        std::size_t ready_count = 0;
+        bool stop = false;
+        std::thread worker;
+    };
+
+    // Slow path: locate or load the page holding `pos`.
+    value_type fault(std::size_t pos) const
+    {
+        const std::size_t page_no = pos / m_options.page_size;
+        const std::size_t from = page_no * m_options.page_size;
+        ++m_tick;
+
+        Page* victim = nullptr;
+        for (auto& page : m_pages) {
+            if (page.count != 0 && page.from == from) {
+                page.last_use = m_tick;
+                m_last = &page;
+                m_window = {page.data.get(), page.from, page.from + page.count};
+                return page.data[pos - from];
+            }
+            if (victim == nullptr || (victim->count != 0 &&
+                                      (page.count == 0 || page.last_use < victim->last_use))) {
+                victim = &page;
+            }
+        }
+
+        std::size_t n = m_prefetch ? m_prefetch->take(page_no, victim->data) : 0;
+        if (n != 0) {
+            ++m_stats.prefetched;
+        } else {
+            n = read_page(page_no, victim->data.get());
+            ++m_stats.disk_reads;
+        }
+        assert(n > pos - from && "PagedFileSource::fault: short read for in-range position");
+        victim->from = from;
+        victim->count = n;
+        victim->last_use = m_tick;
+        m_last = victim;
+        m_window = {victim->data.get(), from, from + n};
+
+        if (m_prefetch && (page_no + 1) * m_options.page_size < m_filesize &&
+            !resident(from + m_options.page_size)) {
+            m_prefetch->request(page_no + 1);
+        }
+        return victim->data[pos - from];
+    }
+
+    bool resident(std::size_t from) const noexcept
+    {
+        for (const auto& page : m_pages) {
+            if (page.count != 0 && page.from == from) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::size_t read_page(std::size_t page_no, value_type* dst) const
+    {
+        const std::size_t byte_pos = page_no * m_options.page_size * sizeof(value_type);
+        if (std::fseek(m_fp, static_cast<long>(byte_pos), SEEK_SET) != 0) {
+            return 0;
+        }
+        return std::fread(dst, sizeof(value_type), m_options.page_size, m_fp);
+    }
+
+    PagedFileOptions m_options;
+    std::size_t m_filesize = 0;
+    mutable std::vector<Page> m_pages;
+    mutable const Page* m_last = nullptr;
+    mutable InputWindow<value_type> m_window;
+    mutable std::uint64_t m_tick = 0;
+    mutable PagedFileStats m_stats;
+    FILE* m_fp = nullptr;
+    std::unique_ptr<Prefetcher> m_prefetch;
+};
+
+} // namespace peg
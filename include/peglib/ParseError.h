@@ -1,6 +1,7 @@
 // ExpectedItem (the "expected" set recorded at the furthest failure
 // position), the to_display customization point, escape helpers, Diagnostic
-// (value-object), and ParseError (exception for cut-committed failure).
+// (value-object), ParseError (exception for cut-committed failure), and
+// LimitKind / ParseLimitError (a parse stopped by Context::limits).
 #pragma once
 #include "peglib/SourceMap.h"
 
@@ -9,6 +10,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <memory>
 #include <optional>
 #include <set>
 #include <sstream>
@@ -47,6 +49,28 @@ struct ExpectedItem
     }
 };
 
+// An ExpectedItem built once, when its expression is constructed, and shared
+// by the expression and every Context that records it. A Context keeps the
+// failures at the furthest position as these pointers, deduplicated by
+// identity, and copies the items out only when the set is read
+// (Context::expected / take_error). Sharing ownership is what makes that
+// deferral safe: the item outlives its expression, which may be a temporary
+// or belong to a Grammar destroyed before the error is read.
+using SharedExpectedItem = std::shared_ptr<const ExpectedItem>;
+
+// An expected item not rendered yet: an object plus the function that
+// describes it, for callers whose item is costly to build. Context::
+// record_failure renders it only when the failure is furthest-or-tied, and
+// keeps the rendered item, never the ref: the object may be a temporary.
+struct ExpectedRef
+{
+    const void* source = nullptr;
+    ExpectedItem (*describe)(const void* source) = nullptr;
+
+    bool operator==(const ExpectedRef&) const noexcept = default;
+    [[nodiscard]] ExpectedItem render() const { return describe(source); }
+};
+
 // ===========================================================================
 // ExpectedSet: the "expected" collection at the furthest failure position.
 //
@@ -88,7 +112,8 @@ public:
 
     // Insert keeping sorted + deduped. Returns an iterator to the item (new or
     // existing) plus whether a new element was inserted, mirroring std::set.
-    std::pair<iterator, bool> insert(ExpectedItem item)
+    // The const& overload copies `item` only if it is new.
+    std::pair<iterator, bool> insert(ExpectedItem&& item)
     {
         auto it = std::lower_bound(m_items.begin(), m_items.end(), item);
         if (it != m_items.end() && *it == item) {
@@ -96,6 +121,14 @@ public:
         }
         return {m_items.insert(it, std::move(item)), true};
     }
+    std::pair<iterator, bool> insert(const ExpectedItem& item)
+    {
+        auto it = std::lower_bound(m_items.begin(), m_items.end(), item);
+        if (it != m_items.end() && *it == item) {
+            return {it, false};
+        }
+        return {m_items.insert(it, item), true};
+    }
 
     // Bulk-append-from-set constructor helper: used by callers that already
     // hold a std::set<ExpectedItem> (e.g. ParseError::to_diagnostic before
@@ -361,35 +394,84 @@ class ParseError : public std::runtime_error
 {
 public:
     ParseError(std::size_t pos, ExpectedSet expected)
-        : std::runtime_error{"peg::ParseError: cut-committed branch failed"}, m_pos{pos},
-          m_expected{std::move(expected)}
+        : std::runtime_error{format(pos, expected)}, m_pos{pos}, m_expected{std::move(expected)}
+    {}
+
+    [[nodiscard]] std::size_t position() const noexcept { return m_pos; }
+    [[nodiscard]] const ExpectedSet& expected() const noexcept { return m_expected; }
+
+    [[nodiscard]] Diagnostic to_diagnostic() const { return Diagnostic{m_pos, m_expected}; }
+
+private:
+    static std::string format(std::size_t pos, const ExpectedSet& expected)
     {
         std::ostringstream oss;
-        oss << "parse error at offset " << m_pos;
-        if (!m_expected.empty()) {
+        oss << "parse error at offset " << pos;
+        if (!expected.empty()) {
             oss << ": expected ";
             bool first = true;
-            for (const auto& item : m_expected) {
+            for (const auto& item : expected) {
                 if (!first)
                     oss << " or ";
                 first = false;
                 oss << item.text;
             }
         }
-        m_what = oss.str();
+        return oss.str();
     }
 
-    [[nodiscard]] std::size_t position() const noexcept { return m_pos; }
-    [[nodiscard]] const ExpectedSet& expected() const noexcept { return m_expected; }
+    std::size_t m_pos;
+    ExpectedSet m_expected;
+};
 
-    [[nodiscard]] Diagnostic to_diagnostic() const { return Diagnostic{m_pos, m_expected}; }
+// Which of a Context's ParseLimits stopped the parse (Context::limits).
+enum class LimitKind
+{
+    None,
+    Steps,     // ParseLimits::max_steps rule applications
+    Deadline,  // ParseLimits::deadline passed
+    Memory,    // arena + memo estimate above ParseLimits::max_memory
+    Depth,     // ParseLimits::max_depth nested rule applications
+    Cancelled, // ParseLimits::cancel was set
+};
 
-    [[nodiscard]] const char* what() const noexcept override { return m_what.c_str(); }
+[[nodiscard]] constexpr const char* to_string(LimitKind kind) noexcept
+{
+    switch (kind) {
+    case LimitKind::None:
+        return "none";
+    case LimitKind::Steps:
+        return "step budget exhausted";
+    case LimitKind::Deadline:
+        return "deadline passed";
+    case LimitKind::Memory:
+        return "memory cap reached";
+    case LimitKind::Depth:
+        return "nesting too deep";
+    case LimitKind::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+// Thrown by Grammar::parse_or_throw when a resource limit stopped the parse.
+// Deliberately not a ParseError: the input was not shown to be invalid, only
+// too costly to finish. `position()` is where the parse was when it stopped.
+class ParseLimitError : public std::runtime_error
+{
+public:
+    ParseLimitError(LimitKind kind, std::size_t pos)
+        : std::runtime_error{std::string{"peg::ParseLimitError: "} + to_string(kind) +
+                             " at offset " + std::to_string(pos)},
+          m_kind{kind}, m_pos{pos}
+    {}
+
+    [[nodiscard]] LimitKind kind() const noexcept { return m_kind; }
+    [[nodiscard]] std::size_t position() const noexcept { return m_pos; }
 
 private:
+    LimitKind m_kind;
     std::size_t m_pos;
-    ExpectedSet m_expected;
-    std::string m_what;
 };
 
 } // namespace peg
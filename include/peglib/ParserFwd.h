@@ -4,11 +4,13 @@
 #include <array>
 #include <cassert>
 #include <concepts>
+#include <cstddef>
 #include <memory>
 #include <set>
 #include <string>
 
 #include "Context.h"
+#include "Generate.h"
 
 namespace peg
 {
@@ -44,6 +46,15 @@ struct ParsingExprInterface
     // Collect names of rules directly referenced by this expression. Default
     // is no-op (leaves); container types and rule-reference types override.
     virtual void collect_rule_refs(std::set<std::string>&) const {}
+
+    // Input generation (Generate.h): the height of this expression's
+    // shallowest derivation, and one random derivation appended to the
+    // generator's output. Default: no derivation (matchers).
+    virtual std::size_t generate_cost(Generator<ElementType>&) const
+    {
+        return Generator<ElementType>::unbounded;
+    }
+    virtual bool generate(Generator<ElementType>&) const { return false; }
 };
 
 // CRTP base for every parsing expression type. Carries the derived-type tag
@@ -91,56 +102,42 @@ bool symbolConsumable(const elem& v, const Functor& f)
     return f(v);
 }
 
-// Record the diagnostic for a failed terminal/token match. Shared by
+// Describe a terminal/token value for the expected set. Shared by
 // TerminalExpr and TokenExpr. Shapes handled in order of specificity:
 // single value → 'x'; array-of-2 → 'lo'..'hi'; iterable → comma-joined;
 // else → fallback.
 //
-// The escaped display string is built LAZILY: record_failure_lazy invokes the
-// producer only when `pos` is furthest-or-tied (i.e. the item would actually
-// be retained). Under ordered-choice backtracking, terminal/token failures
-// fire at every non-matching branch but only the furthest-position ones are
-// kept — so the eager string construction (escape_char_for_expected + snprintf)
-// that the old code did unconditionally was pure waste on every discarded
-// failure, which the profile showed as ~7% of instruction refs.
-template<typename Context, typename V>
-void record_terminal_expected(Context& context, const V& value, std::string_view fallback)
+// Called once per expression, when it is constructed: the expression keeps
+// the item as a SharedExpectedItem (see Context::record_failure). Building
+// the escaped string at every failure that tied the furthest position showed
+// escape + snprintf at ~7% of instruction refs.
+template<typename CharT, typename V>
+ExpectedItem describe_terminal(const V& value, std::string_view fallback)
 {
-    std::size_t pos = context.mark();
-    if constexpr (std::is_same_v<V, typename Context::value_type>) {
-        context.record_failure_lazy(pos, [&]() {
-            return ExpectedItem{.kind = ExpectedKind::Literal,
-                                .text = escape_char_for_expected(value)};
-        });
+    if constexpr (std::is_same_v<V, CharT>) {
+        return ExpectedItem{.kind = ExpectedKind::Literal, .text = escape_char_for_expected(value)};
     } else if constexpr (requires {
                              std::get<0>(value);
                              std::get<1>(value);
                          }) {
-        auto lo = std::get<0>(value);
-        auto hi = std::get<1>(value);
-        context.record_failure_lazy(pos, [&]() {
-            std::string text = escape_char_for_expected(lo) + ".." + escape_char_for_expected(hi);
-            return ExpectedItem{.kind = ExpectedKind::Range, .text = std::move(text)};
-        });
+        std::string text = escape_char_for_expected(std::get<0>(value)) + ".." +
+                           escape_char_for_expected(std::get<1>(value));
+        return ExpectedItem{.kind = ExpectedKind::Range, .text = std::move(text)};
     } else if constexpr (requires {
                              value.begin();
                              value.end();
                          }) {
-        context.record_failure_lazy(pos, [&]() {
-            std::string text;
-            bool first = true;
-            for (const auto& v : value) {
-                if (!first)
-                    text += ", ";
-                first = false;
-                text += escape_char_for_expected(v);
-            }
-            return ExpectedItem{.kind = ExpectedKind::Range, .text = std::move(text)};
-        });
+        std::string text;
+        bool first = true;
+        for (const auto& v : value) {
+            if (!first)
+                text += ", ";
+            first = false;
+            text += escape_char_for_expected(v);
+        }
+        return ExpectedItem{.kind = ExpectedKind::Range, .text = std::move(text)};
     } else {
-        context.record_failure_lazy(pos, [&]() {
-            return ExpectedItem{.kind = ExpectedKind::Literal, .text = std::string{fallback}};
-        });
+        return ExpectedItem{.kind = ExpectedKind::Literal, .text = std::string{fallback}};
     }
 }
 
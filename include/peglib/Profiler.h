@@ -0,0 +1,280 @@
+// RuleProfiler: where parse time goes, by grammar rule.
+//
+// A system profiler attributes time to NonTerminal::parse, SequenceExpr::parse
+// and friends — the same handful of frames for every rule of every grammar.
+// A RuleProfiler attached to a Context keeps a shadow stack of the active
+// rules instead (NonTerminal::parse pushes on entry and pops on exit, memo
+// hits included) and charges time to rule paths:
+//
+//   peg::RuleProfiler prof;                  // exact
+//   ctx.profiler(&prof);
+//   g.parse(ctx);
+//   std::ofstream{"parse.folded"} << prof.folded_stacks();
+//   // flamegraph.pl --countname=ns parse.folded > parse.svg
+//
+// Two modes:
+//   - Exact (RuleProfiler{}): every rule exit reads the clock and charges
+//     the rule's self time (its total minus its children's) to its path.
+//     Precise, at two clock reads per rule application.
+//   - Sampling (RuleProfiler{interval}): a background thread raises a flag
+//     once per interval; the next rule entry or exit to see it charges the
+//     time since the previous sample to the path on top of the shadow
+//     stack. Between samples the hook is a push or pop plus one relaxed
+//     atomic load; attribution is accurate to about one interval.
+//
+// A detached Context (the default) pays one null test per rule application.
+// The skipper and recovery scans are rule applications like any other, so
+// they show up as paths of their own. One profiler can accumulate over many
+// parses, one at a time: it is not thread-safe, and a Context must not
+// outlive the profiler attached to it.
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace peg
+{
+
+class RuleProfiler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Per-rule totals (rules()).
+    struct RuleStats
+    {
+        std::string name;
+        std::uint64_t calls = 0;    // applications, memo hits included
+        std::uint64_t self_ns = 0;  // time in the rule's own body
+        std::uint64_t total_ns = 0; // time with the rule active (recursion counted once)
+    };
+
+    // Exact mode.
+    RuleProfiler() = default;
+
+    // Sampling mode: one sample per `interval` (must be positive).
+    explicit RuleProfiler(std::chrono::nanoseconds interval)
+        : m_sampling{true}, m_ticker{[this, interval](std::stop_token stop) {
+              std::mutex mutex;
+              std::unique_lock lock{mutex};
+              std::condition_variable_any wake;
+              while (!stop.stop_requested()) {
+                  wake.wait_for(lock, stop, interval, [] { return false; });
+                  m_tick.store(true, std::memory_order_relaxed);
+              }
+          }}
+    {}
+
+    // The ticker thread captures `this`.
+    RuleProfiler(const RuleProfiler&) = delete;
+    RuleProfiler& operator=(const RuleProfiler&) = delete;
+
+    [[nodiscard]] bool sampling() const noexcept { return m_sampling; }
+
+    // -----------------------------------------------------------------------
+    // Hooks (NonTerminal::parse). `rule` identifies the rule; `name` is
+    // copied the first time the rule is seen.
+    // -----------------------------------------------------------------------
+    void enter(const void* rule, std::string_view name)
+    {
+        const std::size_t parent = m_stack.empty() ? npos : m_stack.back().path;
+        const std::size_t path = child(parent, rule, name);
+        const std::size_t r = m_paths[path].rule;
+        ++m_rules[r].calls;
+        if (m_sampling) {
+            if (m_stack.empty()) {
+                m_last_sample = Clock::now(); // time between parses is nobody's
+            } else {
+                poll();
+            }
+            m_stack.push_back(Frame{path, {}, 0});
+        } else {
+            ++m_active[r];
+            m_stack.push_back(Frame{path, Clock::now(), 0});
+        }
+    }
+
+    void leave()
+    {
+        if (m_sampling) {
+            poll();
+            m_stack.pop_back();
+            return;
+        }
+        const Frame frame = m_stack.back();
+        m_stack.pop_back();
+        const auto total = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - frame.start)
+                .count());
+        const std::uint64_t self = total - std::min(total, frame.child_ns);
+        Path& path = m_paths[frame.path];
+        path.self_ns += self;
+        RuleStats& stats = m_rules[path.rule];
+        stats.self_ns += self;
+        if (--m_active[path.rule] == 0) {
+            stats.total_ns += total;
+        }
+        if (!m_stack.empty()) {
+            m_stack.back().child_ns += total;
+        }
+    }
+
+    // -----------------------------------------------------------------------
+    // Results.
+    // -----------------------------------------------------------------------
+
+    // One line per rule path with self time: `outer;inner;leaf <ns>`, root
+    // first — Brendan Gregg's folded-stack format. `;` in a rule name is
+    // written as `:` and whitespace as `_`, as the format requires.
+    [[nodiscard]] std::string folded_stacks() const
+    {
+        std::string out;
+        std::vector<std::size_t> chain;
+        for (std::size_t i = 0; i < m_paths.size(); ++i) {
+            if (m_paths[i].self_ns == 0) {
+                continue;
+            }
+            chain.clear();
+            for (std::size_t p = i; p != npos; p = m_paths[p].parent) {
+                chain.push_back(p);
+            }
+            for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+                if (it != chain.rbegin()) {
+                    out += ';';
+                }
+                for (char c : m_rules[m_paths[*it].rule].name) {
+                    out += c == ';' ? ':' : (c == ' ' || c == '\t' || c == '\n') ? '_' : c;
+                }
+            }
+            out += ' ';
+            out += std::to_string(m_paths[i].self_ns);
+            out += '\n';
+        }
+        return out;
+    }
+
+    // Per-rule totals, hottest (by self time) first.
+    [[nodiscard]] std::vector<RuleStats> rules() const
+    {
+        std::vector<RuleStats> out = m_rules;
+        std::stable_sort(out.begin(), out.end(), [](const RuleStats& a, const RuleStats& b) {
+            return a.self_ns > b.self_ns;
+        });
+        return out;
+    }
+
+    // Drop everything recorded so far. Only between parses.
+    void clear()
+    {
+        m_rules.clear();
+        m_rule_index.clear();
+        m_active.clear();
+        m_paths.clear();
+        m_roots.clear();
+        m_stack.clear();
+        m_seen.clear();
+    }
+
+private:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    struct Path
+    {
+        std::size_t parent;
+        std::size_t rule;
+        std::uint64_t self_ns = 0;
+        std::vector<std::pair<const void*, std::size_t>> children; // (rule, path)
+    };
+
+    struct Frame
+    {
+        std::size_t path;
+        Clock::time_point start;
+        std::uint64_t child_ns;
+    };
+
+    std::size_t rule_index(const void* rule, std::string_view name)
+    {
+        auto [it, inserted] = m_rule_index.try_emplace(rule, m_rules.size());
+        if (inserted) {
+            m_rules.push_back(RuleStats{std::string{name}, 0, 0, 0});
+            m_active.push_back(0);
+        }
+        return it->second;
+    }
+
+    // The path for `rule` called from `parent` (npos: a root). A short scan
+    // of the parent's children; the rule table is consulted only for a new
+    // path.
+    std::size_t child(std::size_t parent, const void* rule, std::string_view name)
+    {
+        auto& siblings = parent == npos ? m_roots : m_paths[parent].children;
+        for (const auto& [r, p] : siblings) {
+            if (r == rule) {
+                return p;
+            }
+        }
+        const std::size_t path = m_paths.size();
+        siblings.emplace_back(rule, path); // before push_back: it may move `siblings`
+        m_paths.push_back(Path{parent, rule_index(rule, name), 0, {}});
+        return path;
+    }
+
+    // Sampling: charge the time since the last sample to the top path (self)
+    // and once to every distinct rule on the stack (total).
+    void poll()
+    {
+        if (!m_tick.load(std::memory_order_relaxed)) {
+            return;
+        }
+        m_tick.store(false, std::memory_order_relaxed);
+        const auto now = Clock::now();
+        const auto dt = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last_sample).count());
+        m_last_sample = now;
+        if (m_stack.empty()) {
+            return;
+        }
+        const Path& top = m_paths[m_stack.back().path];
+        m_paths[m_stack.back().path].self_ns += dt;
+        m_rules[top.rule].self_ns += dt;
+        ++m_generation;
+        if (m_seen.size() < m_rules.size()) {
+            m_seen.resize(m_rules.size(), 0);
+        }
+        for (const Frame& f : m_stack) {
+            const std::size_t r = m_paths[f.path].rule;
+            if (m_seen[r] != m_generation) {
+                m_seen[r] = m_generation;
+                m_rules[r].total_ns += dt;
+            }
+        }
+    }
+
+    bool m_sampling = false;
+    std::vector<RuleStats> m_rules;
+    std::unordered_map<const void*, std::size_t> m_rule_index;
+    std::vector<std::size_t> m_active; // exact: open applications per rule
+    std::vector<Path> m_paths;
+    std::vector<std::pair<const void*, std::size_t>> m_roots; // (rule, path)
+    std::vector<Frame> m_stack;
+
+    // Sampling state.
+    std::atomic<bool> m_tick{false};
+    Clock::time_point m_last_sample{};
+    std::uint64_t m_generation = 0;
+    std::vector<std::uint64_t> m_seen; // per rule: last generation counted
+    std::jthread m_ticker;             // last: stopped and joined first
+};
+
+} // namespace peg
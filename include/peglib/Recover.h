@@ -1,28 +1,173 @@
 // RecoverSpec: how a rule resyncs after its body fails. On body failure
-// (with no cut committed), the rule scans forward one char at a time until
-// is_sync_token(c) is true (or input ends), consumes that one sync char,
-// records a diagnostic at the original failure position, and reports success
-// with a transparent null tree.
+// (with no cut committed), the rule scans forward until is_sync_token(c) is
+// true (or input ends), consumes that one sync char, records a diagnostic at
+// the original failure position, and reports success with a transparent
+// null tree.
+//
+// The builders also record what the predicate means (`kind` plus a byte
+// bitmap of the sync set), so the scan need not call is_sync_token once per
+// character: find_sync() walks the input a chunk at a time — the whole buffer
+// for contiguous sources, one page at a time for paged ones — with memchr for
+// a single sync byte, an 8-byte SWAR compare for up to four, and a bitmap
+// lookup otherwise. recover_predicate, and sets holding characters above
+// 0xFF, keep the per-character predicate.
 #pragma once
 #include "peglib/ParseError.h"
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <functional>
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <span>
 #include <string>
+#include <type_traits>
 #include <utility>
 
 namespace peg
 {
 
+enum class RecoverKind
+{
+    Predicate, // opaque: call is_sync_token per character
+    Set,       // any byte in `sync_bytes`
+    Eol,       // '\n'
+    Eof,       // never matches: scan to end of input
+};
+
+// Sync set over byte values 0..255: a 256-bit membership bitmap plus, for
+// sets of up to four members, the members themselves (for memchr / SWAR).
+struct SyncBytes
+{
+    std::array<std::uint64_t, 4> bits{};
+    std::array<unsigned char, 4> members{};
+    std::size_t count = 0;
+
+    void add(unsigned char b) noexcept
+    {
+        if (test(b)) {
+            return;
+        }
+        bits[b >> 6] |= std::uint64_t{1} << (b & 63);
+        if (count < members.size()) {
+            members[count] = b;
+        }
+        ++count;
+    }
+
+    [[nodiscard]] bool test(unsigned char b) const noexcept
+    {
+        return (bits[b >> 6] >> (b & 63)) & 1;
+    }
+
+    // Index of the first byte of [p, p+n) in the set, or n.
+    std::size_t find(const unsigned char* p, std::size_t n) const noexcept
+    {
+        if (count == 1) {
+            const void* hit = std::memchr(p, members[0], n);
+            return hit ? static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - p) : n;
+        }
+        std::size_t i = 0;
+        if (count <= members.size()) {
+            // A word holds a member byte iff (word ^ broadcast(member)) has a
+            // zero byte. The bit trick may also flag a byte just above a true
+            // zero, so a flagged word is rechecked byte by byte.
+            constexpr std::uint64_t lo = 0x0101010101010101ull;
+            constexpr std::uint64_t hi = 0x8080808080808080ull;
+            for (; i + 8 <= n; i += 8) {
+                std::uint64_t w;
+                std::memcpy(&w, p + i, 8);
+                std::uint64_t hit = 0;
+                for (std::size_t m = 0; m < count; ++m) {
+                    const std::uint64_t v = w ^ (lo * members[m]);
+                    hit |= (v - lo) & ~v & hi;
+                }
+                if (hit != 0) {
+                    break;
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            if (test(p[i])) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
 template<typename CharT>
 struct RecoverSpec
 {
     std::function<bool(CharT)> is_sync_token;
     std::string label; // optional; falls back to the rule's name in diagnostics
+    RecoverKind kind = RecoverKind::Predicate;
+    SyncBytes sync_bytes; // RecoverKind::Set only
 
     [[nodiscard]] bool configured() const noexcept { return static_cast<bool>(is_sync_token); }
+
+    // First sync position at or after `pos`, or the end of the input.
+    // `Ctx` is a Context (templated so this header does not include it).
+    // Reaching the end is observed through ended_at() as for any matcher.
+    template<typename Ctx>
+    std::size_t find_sync(const Ctx& context, std::size_t pos) const
+    {
+        if (kind != RecoverKind::Predicate) {
+            while (true) {
+                const std::span<const CharT> run = context.chunk(pos);
+                if (run.empty()) {
+                    break; // end of input, or a source without bulk access
+                }
+                const std::size_t i = find_in(run);
+                pos += i;
+                if (i < run.size()) {
+                    return pos;
+                }
+            }
+        }
+        while (!context.ended_at(pos) && !is_sync_token(context.at(pos))) {
+            ++pos;
+        }
+        return pos;
+    }
+
+private:
+    std::size_t find_in(std::span<const CharT> run) const
+    {
+        if (kind == RecoverKind::Eof) {
+            return run.size();
+        }
+        if constexpr (std::is_integral_v<CharT> && sizeof(CharT) == 1) {
+            const auto* p = reinterpret_cast<const unsigned char*>(run.data());
+            if (kind == RecoverKind::Eol) {
+                const void* hit = std::memchr(p, '\n', run.size());
+                return hit ? static_cast<std::size_t>(static_cast<const unsigned char*>(hit) - p)
+                           : run.size();
+            }
+            return sync_bytes.find(p, run.size());
+        } else if constexpr (std::is_integral_v<CharT>) {
+            for (std::size_t i = 0; i < run.size(); ++i) {
+                const auto c = static_cast<std::make_unsigned_t<CharT>>(run[i]);
+                const bool hit = kind == RecoverKind::Eol
+                                     ? c == '\n'
+                                     : c <= 0xFF && sync_bytes.test(static_cast<unsigned char>(c));
+                if (hit) {
+                    return i;
+                }
+            }
+            return run.size();
+        } else {
+            for (std::size_t i = 0; i < run.size(); ++i) {
+                if (is_sync_token(run[i])) {
+                    return i;
+                }
+            }
+            return run.size();
+        }
+    }
 };
 
 // Builders. recover_set covers fixed token sets ({';', '}'}); recover_eol /
@@ -32,10 +177,24 @@ template<typename CharT>
 RecoverSpec<CharT> recover_set(std::set<CharT> sync, std::string label = {})
 {
     auto sync_copy = std::make_shared<std::set<CharT>>(std::move(sync));
-    return RecoverSpec<CharT>{
+    RecoverSpec<CharT> spec{
         [sync_copy](CharT c) { return sync_copy->count(c) > 0; },
         std::move(label),
+        RecoverKind::Predicate,
+        {},
     };
+    // Analyzable only if every member fits the byte bitmap.
+    if constexpr (std::is_integral_v<CharT>) {
+        for (CharT c : *sync_copy) {
+            const auto u = static_cast<std::make_unsigned_t<CharT>>(c);
+            if (u > 0xFF) {
+                return spec;
+            }
+            spec.sync_bytes.add(static_cast<unsigned char>(u));
+        }
+        spec.kind = RecoverKind::Set;
+    }
+    return spec;
 }
 
 template<typename CharT>
@@ -50,6 +209,8 @@ RecoverSpec<CharT> recover_eol(std::string label = {})
     return RecoverSpec<CharT>{
         [](CharT c) { return c == static_cast<CharT>('\n'); },
         std::move(label),
+        RecoverKind::Eol,
+        {},
     };
 }
 
@@ -61,13 +222,15 @@ RecoverSpec<CharT> recover_eof(std::string label = {})
     return RecoverSpec<CharT>{
         [](CharT) { return false; },
         std::move(label),
+        RecoverKind::Eof,
+        {},
     };
 }
 
 template<typename CharT>
 RecoverSpec<CharT> recover_predicate(std::function<bool(CharT)> pred, std::string label = {})
 {
-    return RecoverSpec<CharT>{std::move(pred), std::move(label)};
+    return RecoverSpec<CharT>{std::move(pred), std::move(label), RecoverKind::Predicate, {}};
 }
 
 // Sugar for `rule.set_recovery(spec)`. Templated on the rule type so this
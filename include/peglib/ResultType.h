@@ -552,20 +552,23 @@ auto fold_start(Ctx& ctx, const NodePtr& node, const NonTerminalPtr& start) ->
 
 // fire_on_match: side-effect walk. Visits every node in pre-order and fires
 // the producer's on_match hook. Independent of the typed fold: a rule with
-// only on_match (no typed fold) still has its hook fire.
+// only on_match (no typed fold) still has its hook fire. Returns the number
+// of nodes visited (ParsePhaseStats).
 template<typename Ctx, typename NodePtr, typename NonTerminalPtr>
-void fire_on_match(Ctx& ctx, const NodePtr& node, const NonTerminalPtr& start)
+std::size_t fire_on_match(Ctx& ctx, const NodePtr& node, const NonTerminalPtr& start)
 {
     if (!node)
-        return;
+        return 0;
     if (start && start->on_match()) {
         start->on_match()(ctx, node);
     } else if (node->producer && node->producer->on_match()) {
         node->producer->on_match()(ctx, node);
     }
+    std::size_t visited = 1;
     for (const auto& child : node->children) {
-        fire_on_match<Ctx, NodePtr, NonTerminalPtr>(ctx, child, nullptr);
+        visited += fire_on_match<Ctx, NodePtr, NonTerminalPtr>(ctx, child, nullptr);
     }
+    return visited;
 }
 
 template<typename C, typename Ctx, typename NodePtr>
@@ -1,15 +1,41 @@
 // SourceMap: byte offset <-> (line, column) mapping.
-// Construction is O(n) prescan; locate() / offset_of() are O(log L).
+// Eager construction (the default) is an O(n) prescan. Lazy construction
+// (SourceMapOptions::lazy) scans nothing: a query extends the prescan up to
+// its offset, in lazy_block steps, so the map pays O(k) for the first k
+// bytes it is asked about. locate() / offset_of() are O(log L).
 // Line endings: \n terminates a line; a preceding \r is part of the
 // terminator. Lone \r is not a line ending.
+//
+// Prescan: newlines are found with memchr (vectorized in every mainstream
+// libc) rather than a byte loop. Paged sources are scanned one page window
+// at a time — one type-erased call per page, not per byte. Contiguous
+// inputs at or above SourceMapOptions::parallel_threshold are split across
+// threads, each collecting its slice's line starts, concatenated in order.
+//
+// Index representation (SourceMapOptions::index): one size_t per line
+// (LineIndex::Vector, the default), or CompactLineIndex (LineIndex::Compact)
+// — ~1–2 bytes per line for typical line lengths, for inputs with so many
+// lines that the vector itself becomes the memory problem.
+//
+// Columns: locate() counts bytes. locate_utf16() (LSP) and
+// locate_codepoint() (terminal UIs) count UTF-16 code units / code points.
+// The prescan keeps one "pure ASCII" bit per line (tested 8 bytes at a time),
+// so on ASCII lines those are O(1); other lines decode only the prefix up to
+// the offset. Invalid UTF-8 is counted leniently (every non-continuation
+// byte is one code point).
 #pragma once
 #include "peglib/FileSource.h"
+#include "peglib/MmapSource.h"
+#include "peglib/PagedFileSource.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 namespace peg
@@ -28,20 +54,166 @@ struct SourceRange
     SourceLocation end;
 };
 
+// Append-only line-start index in blocks of 64 lines: each block stores its
+// first start as an absolute offset plus the other 63 as LEB128 varint deltas
+// (the line lengths). start(i) decodes at most 63 varints; rank(offset)
+// binary-searches the block bases, then decodes within one block.
+class CompactLineIndex
+{
+public:
+    static constexpr std::size_t block_lines = 64;
+
+    void push_back(std::size_t start)
+    {
+        if (m_count % block_lines == 0) {
+            m_bases.push_back(start);
+            m_block_pos.push_back(m_bytes.size());
+        } else {
+            std::size_t delta = start - m_last;
+            while (delta >= 0x80) {
+                m_bytes.push_back(static_cast<std::uint8_t>(delta | 0x80));
+                delta >>= 7;
+            }
+            m_bytes.push_back(static_cast<std::uint8_t>(delta));
+        }
+        m_last = start;
+        ++m_count;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_count; }
+
+    [[nodiscard]] std::size_t operator[](std::size_t i) const noexcept
+    {
+        assert(i < m_count && "CompactLineIndex: index out of range");
+        const std::size_t block = i / block_lines;
+        std::size_t pos = m_block_pos[block];
+        std::size_t value = m_bases[block];
+        for (std::size_t k = i % block_lines; k != 0; --k) {
+            value += decode(pos);
+        }
+        return value;
+    }
+
+    // Index of the last start <= `offset`. Requires (*this)[0] <= offset.
+    [[nodiscard]] std::size_t rank(std::size_t offset) const noexcept
+    {
+        const auto it = std::upper_bound(m_bases.begin(), m_bases.end(), offset);
+        const std::size_t block = static_cast<std::size_t>(it - m_bases.begin()) - 1;
+        std::size_t i = block * block_lines;
+        const std::size_t block_end = std::min(m_count, i + block_lines);
+        std::size_t pos = m_block_pos[block];
+        std::size_t value = m_bases[block];
+        while (i + 1 < block_end) {
+            const std::size_t next = value + decode(pos);
+            if (next > offset) {
+                break;
+            }
+            value = next;
+            ++i;
+        }
+        return i;
+    }
+
+    // Heap bytes held by the index.
+    [[nodiscard]] std::size_t memory_bytes() const noexcept
+    {
+        return m_bases.capacity() * sizeof(std::size_t) +
+               m_block_pos.capacity() * sizeof(std::size_t) + m_bytes.capacity();
+    }
+
+    void shrink_to_fit()
+    {
+        m_bases.shrink_to_fit();
+        m_block_pos.shrink_to_fit();
+        m_bytes.shrink_to_fit();
+    }
+
+private:
+    std::size_t decode(std::size_t& pos) const noexcept
+    {
+        std::size_t value = 0;
+        unsigned shift = 0;
+        std::uint8_t byte = 0;
+        do {
+            byte = m_bytes[pos++];
+            value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return value;
+    }
+
+    std::vector<std::size_t> m_bases;     // absolute start of each block's first line
+    std::vector<std::size_t> m_block_pos; // each block's first delta in m_bytes
+    std::vector<std::uint8_t> m_bytes;    // varint line-length deltas
+    std::size_t m_count = 0;
+    std::size_t m_last = 0;
+};
+
+enum class LineIndex
+{
+    Vector,  // one size_t per line: fastest lookups, apply_edit supported
+    Compact, // CompactLineIndex: ~1-2 bytes per line, no apply_edit
+};
+
+struct SourceMapOptions
+{
+    // Contiguous inputs of at least this many bytes are scanned in parallel.
+    std::size_t parallel_threshold = std::size_t{8} << 20;
+    // Upper bound on scanning threads; 0 = std::thread::hardware_concurrency().
+    unsigned max_threads = 0;
+    // Index on demand: construction scans nothing, and each query scans only
+    // as far as it needs (in blocks of at least lazy_block bytes). Queries
+    // then mutate the index, so a lazy map must not be queried concurrently.
+    bool lazy = false;
+    std::size_t lazy_block = std::size_t{64} << 10;
+    // Line-start representation. Compact maps are always scanned serially
+    // (per-thread partial vectors would cost the memory Compact saves).
+    LineIndex index = LineIndex::Vector;
+};
+
 class SourceMap
 {
 public:
     // Non-owning: caller must keep `source` alive while line_view() is used.
-    explicit SourceMap(std::string_view source) : m_contiguous{source} { prescan(); }
+    explicit SourceMap(std::string_view source, SourceMapOptions options = {})
+        : m_contiguous{source}, m_size{source.size()}, m_lazy_block{options.lazy_block}
+    {
+        select_index(options);
+        if (!options.lazy) {
+            prescan(options);
+        }
+    }
+
+    // A mapped file is contiguous: same as the string_view overload (and
+    // eligible for the parallel scan). The mapping must outlive this map.
+    explicit SourceMap(const MmapSource<char>& source, SourceMapOptions options = {})
+        : SourceMap{source.view(), options}
+    {}
 
     // The FileSource must outlive this SourceMap. PageSize is deduced; the
     // source is held type-erased so SourceMap stays non-templated.
     template<std::size_t PageSize>
-    explicit SourceMap(const FileSource<char, PageSize>& source)
-        : m_file_source{&source}, m_file_size{&SourceMap::impl_size<FileSource<char, PageSize>>},
-          m_file_at{&SourceMap::impl_at<FileSource<char, PageSize>>}
+    explicit SourceMap(const FileSource<char, PageSize>& source, SourceMapOptions options = {})
+        : m_size{source.size()}, m_lazy_block{options.lazy_block}, m_file_source{&source},
+          m_file_at{&SourceMap::impl_at<FileSource<char, PageSize>>},
+          m_file_chunk{&SourceMap::impl_chunk<FileSource<char, PageSize>>}
+    {
+        select_index(options);
+        if (!options.lazy) {
+            scan_to(m_size);
+        }
+    }
+
+    // Same contract for the LRU-paged source.
+    explicit SourceMap(const PagedFileSource<char>& source, SourceMapOptions options = {})
+        : m_size{source.size()}, m_lazy_block{options.lazy_block}, m_file_source{&source},
+          m_file_at{&SourceMap::impl_at<PagedFileSource<char>>},
+          m_file_chunk{&SourceMap::impl_chunk<PagedFileSource<char>>}
     {
-        prescan_file();
+        select_index(options);
+        if (!options.lazy) {
+            scan_to(m_size);
+        }
     }
 
     SourceMap(const SourceMap&) = default;
@@ -51,23 +223,24 @@ public:
 
     // Offsets past EOF stay on the last line; column reflects the raw
     // (unclamped) offset.
-    [[nodiscard]] SourceLocation locate(std::size_t offset) const noexcept
+    [[nodiscard]] SourceLocation locate(std::size_t offset) const
     {
-        auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
-        std::size_t line_idx = static_cast<std::size_t>(it - m_line_starts.begin()) - 1;
-        std::size_t line_start = m_line_starts[line_idx];
+        index_through(offset);
+        std::size_t line_idx = line_index_of(offset);
+        std::size_t line_start = line_start_at(line_idx);
         std::size_t col = offset - line_start + 1;
         std::size_t line = line_idx + 1;
         return SourceLocation{.offset = offset, .line = line, .column = col};
     }
 
     // Returns npos if line is out of range. Both args are 1-based.
-    [[nodiscard]] std::size_t offset_of(std::size_t line, std::size_t column) const noexcept
+    [[nodiscard]] std::size_t offset_of(std::size_t line, std::size_t column) const
     {
-        if (line == 0 || line > m_line_starts.size()) {
+        index_lines(line);
+        if (line == 0 || line > line_count()) {
             return npos;
         }
-        std::size_t line_start = m_line_starts[line - 1];
+        std::size_t line_start = line_start_at(line - 1);
         return line_start + (column - 1);
     }
 
@@ -75,13 +248,14 @@ public:
     [[nodiscard]] std::string_view line_view(std::size_t line) const
     {
         assert(m_file_source == nullptr && "line_view requires a contiguous SourceMap");
-        if (line == 0 || line > m_line_starts.size()) {
+        index_lines(line + 1);
+        if (line == 0 || line > line_count()) {
             return {};
         }
-        std::size_t start = m_line_starts[line - 1];
+        std::size_t start = line_start_at(line - 1);
         std::size_t end;
-        if (line < m_line_starts.size()) {
-            end = m_line_starts[line] - 1; // skip \n
+        if (line < line_count()) {
+            end = line_start_at(line) - 1; // skip \n
             if (end > start && m_contiguous[end - 1] == '\r') {
                 --end; // skip \r in \r\n
             }
@@ -98,22 +272,22 @@ public:
     // the line from disk).
     [[nodiscard]] std::string line_content(std::size_t line) const
     {
-        if (line == 0 || line > m_line_starts.size()) {
-            return {};
-        }
         if (m_file_source == nullptr) {
             return std::string{line_view(line)};
         }
-        std::size_t start = m_line_starts[line - 1];
+        index_lines(line + 1);
+        if (line == 0 || line > line_count()) {
+            return {};
+        }
+        std::size_t start = line_start_at(line - 1);
         std::size_t end;
-        std::size_t source_size = m_file_size(m_file_source);
-        if (line < m_line_starts.size()) {
-            end = m_line_starts[line] - 1;
+        if (line < line_count()) {
+            end = line_start_at(line) - 1;
             if (end > start && m_file_at(m_file_source, end - 1) == '\r') {
                 --end;
             }
         } else {
-            end = source_size;
+            end = m_size;
             if (end > start && m_file_at(m_file_source, end - 1) == '\r') {
                 --end;
             }
@@ -126,56 +300,396 @@ public:
         return result;
     }
 
-    [[nodiscard]] std::size_t num_lines() const noexcept { return m_line_starts.size(); }
+    [[nodiscard]] std::size_t num_lines() const
+    {
+        scan_to(m_size);
+        return line_count();
+    }
     [[nodiscard]] std::string_view source_view() const noexcept { return m_contiguous; }
 
+    // locate() with the column in UTF-16 code units (LSP's default) or in
+    // code points. O(1) on ASCII lines; otherwise decodes the line prefix.
+    [[nodiscard]] SourceLocation locate_utf16(std::size_t offset) const
+    {
+        return locate_units(offset, true);
+    }
+    [[nodiscard]] SourceLocation locate_codepoint(std::size_t offset) const
+    {
+        return locate_units(offset, false);
+    }
+
+    // True if every byte of `line` (1-based) is ASCII. Out-of-range lines,
+    // and lines a lazy map has not finished scanning, report false.
+    [[nodiscard]] bool is_ascii_line(std::size_t line) const
+    {
+        index_lines(line + 1);
+        if (line == 0 || line > line_count()) {
+            return false;
+        }
+        if (line - 1 < m_line_ascii.size()) {
+            return m_line_ascii[line - 1];
+        }
+        // The last line has no terminating newline: known once fully scanned.
+        return m_indexed_to >= m_size && m_scan_ascii;
+    }
+
+    // Bytes of the source indexed so far (the whole source unless lazy).
+    [[nodiscard]] std::size_t indexed_bytes() const noexcept { return m_indexed_to; }
+
+    // Heap bytes held by the line index (including the per-line ASCII bits).
+    [[nodiscard]] std::size_t index_memory_bytes() const noexcept
+    {
+        return (m_compact ? m_compact_index.memory_bytes()
+                          : m_line_starts.capacity() * sizeof(std::size_t)) +
+               m_line_ascii.capacity() / 8;
+    }
+
+    // -----------------------------------------------------------------------
+    // Incremental update (contiguous maps, LineIndex::Vector). Replace `removed` bytes at
+    // `offset` with `inserted`: line starts inside the removed range are
+    // dropped, those after it shift by the size delta, and the inserted
+    // text's newlines are spliced in — no rescan of the unchanged text. In
+    // lazy mode an edit reaching past the indexed prefix just truncates the
+    // index at `offset`; the rest is rescanned on demand.
+    //
+    // The map is non-owning: if the edited text now lives in a different
+    // buffer (or the old one reallocated), rebind() it before the next query.
+    // -----------------------------------------------------------------------
+    void apply_edit(std::size_t offset, std::size_t removed, std::string_view inserted)
+    {
+        assert(m_file_source == nullptr && "apply_edit requires a contiguous SourceMap");
+        assert(!m_compact && "apply_edit requires LineIndex::Vector");
+        assert(offset + removed <= m_size && "apply_edit: edit past end of source");
+        const std::size_t grown = m_size - removed + inserted.size();
+
+        if (m_indexed_to < offset + removed) {
+            if (m_indexed_to > offset) {
+                m_line_starts.erase(
+                    std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset),
+                    m_line_starts.end());
+                m_line_ascii.resize(m_line_starts.size() - 1);
+                m_scan_ascii = false; // the open line's scanned prefix is unknown now
+                m_indexed_to = offset;
+            }
+            m_size = grown;
+            return;
+        }
+
+        std::vector<std::size_t> added;
+        {
+            std::vector<bool> unused_bits;
+            bool unused_ascii = true;
+            scan_newlines(
+                inserted.data(), inserted.size(), offset, added, unused_bits, unused_ascii);
+        }
+        const auto first = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
+        const auto last = std::upper_bound(first, m_line_starts.end(), offset + removed);
+        for (auto it = last; it != m_line_starts.end(); ++it) {
+            *it = *it - removed + inserted.size();
+        }
+
+        // ASCII bits: bit k belongs to the line ended by the k-th newline.
+        // The removed newlines ended lines [a-1, b-1); the inserted ones end
+        // new lines there. Every line the edit touches is marked non-ASCII —
+        // conservative (its columns are then decoded), never wrong.
+        const auto a = static_cast<std::size_t>(first - m_line_starts.begin());
+        const auto b = static_cast<std::size_t>(last - m_line_starts.begin());
+        m_line_ascii.erase(m_line_ascii.begin() + static_cast<std::ptrdiff_t>(a - 1),
+                           m_line_ascii.begin() + static_cast<std::ptrdiff_t>(b - 1));
+        m_line_ascii.insert(
+            m_line_ascii.begin() + static_cast<std::ptrdiff_t>(a - 1), added.size(), false);
+        clear_line_ascii(a - 1 + added.size());
+
+        const auto at = m_line_starts.erase(first, last);
+        m_line_starts.insert(at, added.begin(), added.end());
+        m_indexed_to = m_indexed_to - removed + inserted.size();
+        m_size = grown;
+    }
+
+    // Point a contiguous map at the (already edited) text.
+    void rebind(std::string_view source) noexcept
+    {
+        assert(m_file_source == nullptr && "rebind requires a contiguous SourceMap");
+        assert(source.size() == m_size && "rebind: size disagrees with applied edits");
+        m_contiguous = source;
+    }
+
     static constexpr std::size_t npos = static_cast<std::size_t>(-1);
 
 private:
-    void prescan()
+    // Append the line start after every '\n' in data[0, n), as offsets
+    // relative to `base`. Out is a std::vector or a CompactLineIndex.
+    //
+    // ASCII tracking: `ascii` is the running flag for the line being scanned
+    // (it may have started in an earlier chunk). Each newline pushes it into
+    // `bits` (so bit k is the line ended by the k-th newline) and resets it.
+    template<typename Out>
+    static void scan_newlines(const char* data,
+                              std::size_t n,
+                              std::size_t base,
+                              Out& out,
+                              std::vector<bool>& bits,
+                              bool& ascii)
     {
-        m_line_starts.clear();
-        m_line_starts.push_back(0);
-        for (std::size_t i = 0; i < m_contiguous.size(); ++i) {
-            if (m_contiguous[i] == '\n') {
-                m_line_starts.push_back(i + 1);
+        const char* p = data;
+        const char* const end = data + n;
+        while (p != end) {
+            const void* hit = std::memchr(p, '\n', static_cast<std::size_t>(end - p));
+            const char* seg_end = hit != nullptr ? static_cast<const char*>(hit) : end;
+            if (ascii) {
+                ascii = is_ascii(p, static_cast<std::size_t>(seg_end - p));
             }
+            if (hit == nullptr) {
+                break;
+            }
+            bits.push_back(ascii);
+            ascii = true;
+            out.push_back(base + static_cast<std::size_t>(seg_end - data) + 1);
+            p = seg_end + 1;
         }
     }
 
-    void prescan_file()
+    // SWAR: OR the bytes together 8 at a time; any high bit means non-ASCII.
+    static bool is_ascii(const char* p, std::size_t n) noexcept
     {
-        m_line_starts.clear();
-        m_line_starts.push_back(0);
-        std::size_t end_pos = m_file_size(m_file_source);
-        for (std::size_t i = 0; i < end_pos; ++i) {
-            char c = m_file_at(m_file_source, i);
-            if (c == '\n') {
-                m_line_starts.push_back(i + 1);
+        std::uint64_t acc = 0;
+        for (; n >= 8; p += 8, n -= 8) {
+            std::uint64_t word;
+            std::memcpy(&word, p, sizeof word);
+            acc |= word;
+        }
+        for (; n != 0; ++p, --n) {
+            acc |= static_cast<unsigned char>(*p);
+        }
+        return (acc & 0x8080808080808080ULL) == 0;
+    }
+
+    // Count UTF-8 code points (or UTF-16 units: 4-byte sequences count two)
+    // in data[0, n): every byte that is not a continuation byte starts one.
+    static std::size_t count_units(const char* data, std::size_t n, bool utf16) noexcept
+    {
+        std::size_t units = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto c = static_cast<unsigned char>(data[i]);
+            if ((c & 0xC0) != 0x80) {
+                units += (utf16 && c >= 0xF0) ? 2 : 1;
             }
         }
+        return units;
     }
 
-    // Type-erased FileSource accessors (PageSize varies; SourceMap is non-templated).
-    template<typename Fs>
-    static std::size_t impl_size(const void* p)
+    SourceLocation locate_units(std::size_t offset, bool utf16) const
+    {
+        SourceLocation loc = locate(offset);
+        if (is_ascii_line(loc.line)) {
+            return loc;
+        }
+        // Decode [line start, offset); bytes past EOF count one each, as in
+        // locate().
+        const std::size_t start = offset - (loc.column - 1);
+        const std::size_t stop = std::min(offset, m_size);
+        std::size_t units = 0;
+        if (m_file_source == nullptr) {
+            units = count_units(m_contiguous.data() + start, stop - start, utf16);
+        } else {
+            for (std::size_t pos = start; pos < stop;) {
+                const std::string_view run = m_file_chunk(m_file_source, pos);
+                const std::size_t take = std::min(run.size(), stop - pos);
+                units += count_units(run.data(), take, utf16);
+                pos += take;
+            }
+        }
+        loc.column = units + (offset - stop) + 1;
+        return loc;
+    }
+
+    void clear_line_ascii(std::size_t idx)
     {
-        return static_cast<const Fs*>(p)->size();
+        if (idx < m_line_ascii.size()) {
+            m_line_ascii[idx] = false;
+        } else {
+            m_scan_ascii = false;
+        }
     }
+
+    void prescan(const SourceMapOptions& options)
+    {
+        const std::size_t n = m_contiguous.size();
+
+        unsigned threads = options.max_threads != 0 ? options.max_threads
+                                                    : std::thread::hardware_concurrency();
+        if (m_compact || n < options.parallel_threshold || threads < 2 || n < threads) {
+            scan_to(n);
+            return;
+        }
+
+        // Newlines are independent bytes, so slices may split anywhere. A
+        // slice's first ASCII bit covers only the tail of a line that began
+        // in an earlier slice; the merge ANDs it with the carried flag.
+        struct Slice
+        {
+            std::vector<std::size_t> starts;
+            std::vector<bool> bits;
+            bool tail_ascii = true;
+        };
+        const std::size_t slice = (n + threads - 1) / threads;
+        std::vector<Slice> partial(threads);
+        std::vector<std::thread> workers;
+        workers.reserve(threads - 1);
+        auto scan_slice = [this, slice, n, &partial](unsigned i) {
+            const std::size_t from = std::min(n, i * slice);
+            const std::size_t to = std::min(n, from + slice);
+            Slice& sl = partial[i];
+            scan_newlines(
+                m_contiguous.data() + from, to - from, from, sl.starts, sl.bits, sl.tail_ascii);
+        };
+        unsigned spawned = 1;
+        try {
+            for (; spawned < threads; ++spawned) {
+                workers.emplace_back(scan_slice, spawned);
+            }
+        } catch (...) {
+            // Thread creation failed: the remaining slices run on this thread.
+        }
+        scan_slice(0);
+        for (unsigned i = spawned; i < threads; ++i) {
+            scan_slice(i);
+        }
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        std::size_t total = m_line_starts.size();
+        for (const auto& p : partial) {
+            total += p.starts.size();
+        }
+        m_line_starts.reserve(total);
+        m_line_ascii.reserve(total);
+        bool carry = true;
+        for (const auto& p : partial) {
+            m_line_starts.insert(m_line_starts.end(), p.starts.begin(), p.starts.end());
+            if (p.bits.empty()) {
+                carry = carry && p.tail_ascii;
+                continue;
+            }
+            m_line_ascii.push_back(carry && p.bits.front());
+            m_line_ascii.insert(m_line_ascii.end(), p.bits.begin() + 1, p.bits.end());
+            carry = p.tail_ascii;
+        }
+        m_scan_ascii = carry;
+        m_indexed_to = n;
+    }
+
+    // Extend the index to cover at least [0, min(to, size)). Lazy queries
+    // scan ahead in lazy_block steps so a run of increasing offsets is not
+    // one scan call each.
+    void scan_to(std::size_t to) const
+    {
+        if (m_indexed_to >= m_size || m_indexed_to >= to) {
+            return;
+        }
+        const std::size_t from = m_indexed_to;
+        const std::size_t end = std::min(m_size, std::max(to, from + m_lazy_block));
+        if (m_file_source == nullptr) {
+            append_starts(m_contiguous.data() + from, end - from, from);
+            m_indexed_to = end;
+        } else {
+            std::size_t pos = from;
+            while (pos < end) {
+                const std::string_view run = m_file_chunk(m_file_source, pos);
+                append_starts(run.data(), run.size(), pos);
+                pos += run.size();
+            }
+            m_indexed_to = pos;
+        }
+        if (m_compact && m_indexed_to >= m_size) {
+            m_compact_index.shrink_to_fit();
+        }
+    }
+
+    void append_starts(const char* data, std::size_t n, std::size_t base) const
+    {
+        if (m_compact) {
+            scan_newlines(data, n, base, m_compact_index, m_line_ascii, m_scan_ascii);
+        } else {
+            scan_newlines(data, n, base, m_line_starts, m_line_ascii, m_scan_ascii);
+        }
+    }
+
+    void select_index(const SourceMapOptions& options)
+    {
+        if (options.index == LineIndex::Compact) {
+            m_compact = true;
+            m_line_starts.clear();
+            m_line_starts.shrink_to_fit();
+            m_compact_index.push_back(0);
+        }
+    }
+
+    // Representation-independent access to the (known) line starts.
+    std::size_t line_count() const noexcept
+    {
+        return m_compact ? m_compact_index.size() : m_line_starts.size();
+    }
+    std::size_t line_start_at(std::size_t idx) const noexcept
+    {
+        return m_compact ? m_compact_index[idx] : m_line_starts[idx];
+    }
+    // 0-based index of the line containing `offset`.
+    std::size_t line_index_of(std::size_t offset) const noexcept
+    {
+        if (m_compact) {
+            return m_compact_index.rank(offset);
+        }
+        auto it = std::upper_bound(m_line_starts.begin(), m_line_starts.end(), offset);
+        return static_cast<std::size_t>(it - m_line_starts.begin()) - 1;
+    }
+
+    // Every line start <= offset is known once [0, offset) is scanned.
+    void index_through(std::size_t offset) const { scan_to(offset); }
+
+    // Know the first `n` line starts, or all of them if there are fewer.
+    void index_lines(std::size_t n) const
+    {
+        while (line_count() < n && m_indexed_to < m_size) {
+            scan_to(m_indexed_to + 1);
+        }
+    }
+
+    // Type-erased FileSource accessors (PageSize varies; SourceMap is non-templated).
     template<typename Fs>
     static char impl_at(const void* p, std::size_t i)
     {
         return static_cast<const Fs*>(p)->at(i);
     }
 
-    using size_fn_t = std::size_t (*)(const void*);
+    // Fault the page holding `pos` in and return its window from `pos` on.
+    template<typename Fs>
+    static std::string_view impl_chunk(const void* p, std::size_t pos)
+    {
+        const Fs& fs = *static_cast<const Fs*>(p);
+        (void)fs.at(pos);
+        const auto& w = fs.window();
+        return {w.data + (pos - w.begin), w.end - pos};
+    }
+
     using at_fn_t = char (*)(const void*, std::size_t);
+    using chunk_fn_t = std::string_view (*)(const void*, std::size_t);
 
-    std::vector<std::size_t> m_line_starts;
+    mutable std::vector<std::size_t> m_line_starts{0};
+    mutable CompactLineIndex m_compact_index;
+    bool m_compact = false;
+    // Bit k: the line ended by the k-th newline is pure ASCII. m_scan_ascii
+    // is the running flag for the line after the last newline scanned.
+    mutable std::vector<bool> m_line_ascii;
+    mutable bool m_scan_ascii = true;
+    mutable std::size_t m_indexed_to = 0; // bytes [0, m_indexed_to) are scanned
     std::string_view m_contiguous;
+    std::size_t m_size = 0;
+    std::size_t m_lazy_block = std::size_t{64} << 10;
     const void* m_file_source{};
-    size_fn_t m_file_size{};
     at_fn_t m_file_at{};
+    chunk_fn_t m_file_chunk{};
 };
 
 } // namespace peg
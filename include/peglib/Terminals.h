@@ -19,19 +19,36 @@ namespace parsers
 template<typename Context, typename TerminalValueType>
 struct TerminalExpr : ParsingExpr<Context, TerminalExpr<Context, TerminalValueType>>
 {
-    explicit TerminalExpr(TerminalValueType value) : m_terminalValue{std::move(value)} {}
+    explicit TerminalExpr(TerminalValueType value)
+        : m_terminalValue{std::move(value)},
+          m_expected{std::make_shared<const ExpectedItem>(
+              describe_terminal<typename Context::value_type>(m_terminalValue, "<terminal>"))}
+    {
+    }
     typename Context::ParseResult parse(Context& context) const override
     {
         if (!context.ended() && symbolConsumable(context.current(), m_terminalValue)) {
             context.next();
             return {true, nullptr};
         }
-        record_terminal_expected(context, m_terminalValue, "<terminal>");
+        context.record_failure(context.mark(), m_expected);
         return {false, nullptr};
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        return gen.emit_matching(m_terminalValue);
+    }
+
 protected:
     TerminalValueType m_terminalValue;
+
+private:
+    SharedExpectedItem m_expected;
 };
 
 // Matches a contiguous run of elements (random-access range).
@@ -39,7 +56,11 @@ template<typename Context, typename SeqType>
     requires std::ranges::random_access_range<SeqType>
 struct TerminalSeqExpr : ParsingExpr<Context, TerminalSeqExpr<Context, SeqType>>
 {
-    TerminalSeqExpr(SeqType value) : m_terminalValues{std::move(value)} {}
+    TerminalSeqExpr(SeqType value)
+        : m_terminalValues{std::move(value)},
+          m_expected{std::make_shared<const ExpectedItem>(describe(m_terminalValues))}
+    {
+    }
     typename Context::ParseResult parse(Context& context) const override
     {
         auto initState = context.state();
@@ -48,31 +69,40 @@ struct TerminalSeqExpr : ParsingExpr<Context, TerminalSeqExpr<Context, SeqType>>
                 context.next();
             } else {
                 context.state(initState);
-                record_expected(context);
+                context.record_failure(context.mark(), m_expected);
                 return {false, nullptr};
             }
         }
         return {true, nullptr};
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        for (const auto& v : m_terminalValues) {
+            gen.emit(v);
+        }
+        return true;
+    }
+
 protected:
     SeqType m_terminalValues;
 
 private:
-    void record_expected(Context& context) const
-    {
-        std::size_t pos = context.mark();
-        // Lazy: build the escaped literal only if this position is retained
-        // (furthest-or-tied). See record_terminal_expected for rationale.
-        context.record_failure_lazy(pos, [&]() {
-            std::string text;
-            for (const auto& v : m_terminalValues) {
-                text += to_display_cpo(v);
-            }
-            return ExpectedItem{.kind = ExpectedKind::Literal,
-                                .text = escape_string_for_expected(text)};
-        });
+    static ExpectedItem describe(const SeqType& values)
+    {
+        std::string text;
+        for (const auto& v : values) {
+            text += to_display_cpo(v);
+        }
+        return ExpectedItem{.kind = ExpectedKind::Literal,
+                            .text = escape_string_for_expected(text)};
     }
+
+    SharedExpectedItem m_expected;
 };
 
 // Like TerminalExpr but **keeps** the matched element as a typed result
@@ -82,7 +112,12 @@ private:
 template<typename Context, typename TerminalValueType>
 struct TokenExpr : ParsingExpr<Context, TokenExpr<Context, TerminalValueType>>
 {
-    TokenExpr(TerminalValueType value) : m_terminalValue{std::move(value)} {}
+    TokenExpr(TerminalValueType value)
+        : m_terminalValue{std::move(value)},
+          m_expected{std::make_shared<const ExpectedItem>(
+              describe_terminal<typename Context::value_type>(m_terminalValue, "<token>"))}
+    {
+    }
 
     typename Context::ParseResult parse(Context& context) const override
     {
@@ -93,12 +128,24 @@ struct TokenExpr : ParsingExpr<Context, TokenExpr<Context, TerminalValueType>>
             node->end_offset = context.mark();
             return {true, node};
         }
-        record_terminal_expected(context, m_terminalValue, "<token>");
+        context.record_failure(context.mark(), m_expected);
         return {false, nullptr};
     }
 
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>& gen) const override
+    {
+        return gen.emit_matching(m_terminalValue);
+    }
+
 protected:
     TerminalValueType m_terminalValue;
+
+private:
+    SharedExpectedItem m_expected;
 };
 
 // Match-time primitive (a weakened lpeg.Cmt). Wraps a user function
@@ -139,6 +186,12 @@ struct EmptyExpr : ParsingExpr<Context, EmptyExpr<Context>>
     {
         return {true, nullptr};
     }
+
+    std::size_t generate_cost(Generator<typename Context::value_type>&) const override
+    {
+        return 0;
+    }
+    bool generate(Generator<typename Context::value_type>&) const override { return true; }
 };
 
 } // namespace parsers
@@ -3,6 +3,7 @@
 
 #include "doctest.h"
 
+#include <stdexcept>
 #include <string>
 
 using namespace peg;
@@ -88,6 +89,193 @@ TEST_CASE("context-cut-stack-lifecycle")
     context.remove_cut();
 }
 
+TEST_CASE("context-node-and-memo-counters")
+{
+    Grammar<> g;
+    g["digit"] = g.terminal('0', '9');
+    g["pair"] = g["digit"] >> g["digit"];
+    g["list"] = +(g["pair"] | g["digit"]);
+
+    std::string input = "12345";
+    Context ctx(input);
+    CHECK(ctx.node_count() == 0);
+    CHECK(ctx.memo_entry_count() == 0);
+    REQUIRE(g.parse_tree("list", ctx));
+    CHECK(ctx.ended());
+    CHECK(ctx.node_count() > 0);
+    // digit at 0..5 (5 is the failed attempt at end of input; the `digit`
+    // fallback at 4 hits the memo), pair at 0, 2, 4, 5, and list at 0.
+    CHECK(ctx.memo_entry_count() == 11);
+
+    // A cut drops the memo below its commit point; the arena keeps its nodes.
+    Grammar<> gc;
+    gc["digit"] = gc.terminal('0', '9');
+    gc["stmt"] = (gc.terminal('a') >> gc.cut() >> gc["digit"]) | gc["digit"];
+    gc["prog"] = *gc["stmt"];
+    std::string cut_input = "a1a2a3";
+    Context cctx(cut_input);
+    REQUIRE(gc.parse("prog", cctx));
+    CHECK(cctx.memo_entry_count() < 6);
+    CHECK(cctx.node_count() > 0);
+}
+
+TEST_CASE("context-cut-releases-memo-by-position")
+{
+    // The memo is stored in position blocks (MemoTable.h): a cut releases
+    // exactly the entries before it, and the counters follow.
+    Grammar<> g;
+    g["digit"] = g.terminal('0', '9');
+    const auto* rule = g["digit"].impl();
+    std::string input(300, '1');
+    Context ctx(input);
+    for (std::size_t pos : {0, 1, 63, 64, 65, 130, 200, 299}) {
+        (void)ctx.rule_state(rule, pos);
+    }
+    CHECK(ctx.memo_entry_count() == 8);
+    CHECK(ctx.memory_stats().memo_blocks == 5); // 64 positions each
+
+    auto commit_at = [&ctx](std::size_t pos) {
+        ctx.reset(pos);
+        ctx.init_cut();
+        ctx.cut(true);
+        ctx.remove_cut();
+    };
+    commit_at(64); // 0, 1, 63: the whole first block
+    CHECK(ctx.memo_entry_count() == 5);
+    CHECK(ctx.memory_stats().memo_blocks == 4);
+    commit_at(131); // 64, 65, 130: a whole block and part of the next
+    CHECK(ctx.memo_entry_count() == 2);
+    CHECK(std::get<0>(ctx.rule_state(rule, 200)) == false); // still memoized
+
+    // Rewinding below the cut and memoizing there again is allowed; the
+    // next commit releases the new entries too.
+    (void)ctx.rule_state(rule, 10);
+    (void)ctx.rule_state(rule, 140);
+    CHECK(ctx.memo_entry_count() == 4);
+    CHECK(std::get<0>(ctx.rule_state(rule, 10)) == false);
+    commit_at(150);
+    CHECK(ctx.memo_entry_count() == 2);
+    CHECK(std::get<0>(ctx.rule_state(rule, 140)) == true); // released: a fresh entry
+    CHECK(ctx.memo_entry_count() == 3);
+}
+
+TEST_CASE("context-memory-stats")
+{
+    Grammar<> g;
+    g["digit"] = g.terminal('0', '9');
+    g["pair"] = g["digit"] >> g["digit"];
+    g["list"] = +(g["pair"] | g["digit"]);
+
+    std::string input = "12345";
+    Context ctx(input);
+    const MemoryStats before = ctx.memory_stats();
+    CHECK(before.arena_nodes == 0);
+    CHECK(before.memo_entries == 0);
+    CHECK(before.bytes() == 0);
+
+    auto tree = g.parse_tree("list", ctx);
+    REQUIRE(tree);
+    const MemoryStats stats = ctx.memory_stats(tree);
+    CHECK(stats.arena_nodes == ctx.node_count());
+    CHECK(stats.memo_entries == ctx.memo_entry_count());
+    CHECK(stats.memo_positions == 6); // 0..5
+    CHECK(stats.memo_blocks == 1); // positions 0..63
+    CHECK(stats.memo_slot_capacity >= stats.memo_entries);
+    CHECK(stats.arena_bytes >= stats.arena_nodes * sizeof(Context<char>::ParseTreeNode));
+    CHECK(stats.memo_bytes > before.memo_bytes);
+    // Reachable: list, its pair / pair / digit alternatives and their
+    // digits. The failed `pair` at 4 and the end-of-input probes are garbage.
+    CHECK(stats.tree_nodes > 0);
+    CHECK(stats.garbage_nodes > 0);
+    CHECK(stats.tree_nodes + stats.garbage_nodes == stats.arena_nodes);
+    CHECK(ctx.memory_stats().tree_nodes == 0);
+    CHECK(stats.growing_heads == 0); // only live during a left-recursive parse
+    CHECK(stats.diagnostics == 0);
+    CHECK(stats.resident_pages == 0); // in-memory input
+}
+
+TEST_CASE("context-memory-stats-counts-resident-pages")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    auto context = from_file<char, 64>(license_path);
+    // FileSource fills both of its buffers on open.
+    CHECK(context.memory_stats().resident_pages == 2);
+    // A cut at 100 releases the first 64-byte page.
+    for (int i = 0; i < 100; ++i) {
+        context.next();
+    }
+    context.init_cut();
+    context.cut(true);
+    context.remove_cut();
+    CHECK(context.memory_stats().resident_pages == 1);
+}
+
+TEST_CASE("context-rebind-resets-state-and-keeps-capacity")
+{
+    // Left recursion (growing heads), a cut per statement (memo release)
+    // and a failure to record.
+    Grammar<> g;
+    g["num"] = +g.terminal('0', '9');
+    g["sum"] = g["sum"] >> g.terminal('+') >> g["num"] | g["num"];
+    g["stmt"] = g.terminal('!') >> g.cut() >> g["sum"] >> g.terminal(';') |
+                g["sum"] >> g.terminal(';');
+    g["prog"] = +g["stmt"];
+
+    std::string first = "1+2;!3+4;5;";
+    Context ctx(first);
+    REQUIRE(g.parse("prog", ctx));
+    const MemoryStats warm = ctx.memory_stats();
+    CHECK(warm.memo_spare_blocks == 0);
+
+    // A different buffer with the same text: the state matches a fresh
+    // Context's, and the arena and memo come from the first parse.
+    const std::string second = first;
+    ctx.rebind(second);
+    CHECK(ctx.mark() == 0);
+    CHECK(ctx.input_size() == second.size());
+    CHECK(ctx.node_count() == 0);
+    CHECK(ctx.memo_entry_count() == 0);
+    CHECK_FALSE(ctx.has_error());
+    const MemoryStats cleared = ctx.memory_stats();
+    CHECK(cleared.arena_nodes == 0);
+    CHECK(cleared.spare_nodes == warm.arena_nodes);
+    CHECK(cleared.memo_blocks == 0);
+    CHECK(cleared.memo_spare_blocks >= 1);
+    CHECK(cleared.bytes() >= warm.bytes() / 2);
+
+    Context fresh(second);
+    REQUIRE(g.parse("prog", fresh));
+    REQUIRE(g.parse("prog", ctx));
+    CHECK(ctx.mark() == fresh.mark());
+    CHECK(ctx.node_count() == fresh.node_count());
+    CHECK(ctx.memo_entry_count() == fresh.memo_entry_count());
+    CHECK(ctx.furthest_failure_pos() == fresh.furthest_failure_pos());
+    CHECK(ctx.memory_stats().spare_nodes == 0);
+
+    // A failed parse leaves an error and diagnostics state behind; the next
+    // rebind drops it. Reused nodes start empty.
+    const std::string bad = "1+;";
+    ctx.rebind(bad);
+    CHECK_FALSE(g.parse("prog", ctx));
+    CHECK(ctx.has_error());
+    ctx.rebind(second);
+    CHECK_FALSE(ctx.has_error());
+    auto tree = g.parse_tree("prog", ctx);
+    REQUIRE(tree);
+    CHECK(tree->start_offset == 0);
+    CHECK(tree->end_offset == second.size());
+    CHECK(tree->children.size() == 3);
+
+    // clear() alone re-parses the same input.
+    ctx.clear();
+    CHECK(ctx.mark() == 0);
+    CHECK(g.parse("prog", ctx));
+    CHECK(ctx.ended());
+
+    auto file = from_file<char>(std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE");
+    CHECK_THROWS_AS(file.rebind(second), std::logic_error);
+}
+
 TEST_CASE("context-input-slice-and-at-read-by-offset")
 {
     std::string input = "xyz";
@@ -156,3 +344,50 @@ TEST_CASE("context-release-before-invoked-for-filesource")
     char c = context.current();
     CHECK(c == start_char);
 }
+
+// ---------------------------------------------------------------------------
+// Bulk access: chunk() / view() / InputSourceBase::read.
+// ---------------------------------------------------------------------------
+
+TEST_CASE("context-view-is-zero-copy-over-contiguous-input")
+{
+    std::string input = "key = value";
+    Context context(input);
+
+    auto v = context.view(Span{6, 11});
+    CHECK(v == "value");
+    CHECK(v.data() == input.data() + 6);
+
+    auto run = context.chunk(4);
+    CHECK(run.data() == input.data() + 4);
+    CHECK(run.size() == input.size() - 4);
+    CHECK(context.chunk(input.size()).empty());
+    CHECK(context.view(Span{3, 3}).empty());
+}
+
+TEST_CASE("context-view-over-filesource-pins-page-or-copies-once")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    auto context = from_file<char, 64>(license_path);
+    const std::string expected = context.input().slice(0, context.input_size());
+    REQUIRE(expected.size() > 300);
+
+    // Within one page: points into the page window.
+    auto inside = context.view(Span{70, 90});
+    CHECK(inside == std::string_view{expected}.substr(70, 20));
+    CHECK(context.input().window()->contains(70));
+    CHECK(inside.data() == context.input().window()->data + (70 - 64));
+
+    // chunk() runs to the end of the page holding pos.
+    auto run = context.chunk(100);
+    CHECK(run.size() == 128 - 100);
+
+    // Across several pages: copied once, still the right text.
+    auto across = context.view(Span{10, 300});
+    CHECK(across == std::string_view{expected}.substr(10, 290));
+
+    // read() copies page runs and agrees with at().
+    std::string buf(150, '\0');
+    context.input().read(200, buf.size(), buf.data());
+    CHECK(buf == expected.substr(200, 150));
+}
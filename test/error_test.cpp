@@ -16,6 +16,7 @@ using Ctxt = Context<char>;
 // Covers:
 //   - escape_char_for_expected, escape_string_for_expected
 //   - Context::record_failure / furthest_failure_pos / expected / take_error
+//   - The error stays readable after the Grammar that produced it is gone
 //   - NonTerminal set_name/set_label producing expected items on failure
 //   - TerminalExpr recording Literal expectations on failure
 //   - Multiple alternatives at the same position accumulate into expected set
@@ -126,6 +127,43 @@ TEST_CASE("error-context-take-error")
     CHECK_FALSE(err2.has_value());
 }
 
+namespace
+{
+int g_describe_calls = 0;
+ExpectedItem describe_counted(const void* source)
+{
+    ++g_describe_calls;
+    return ExpectedItem{ExpectedKind::Literal, static_cast<const char*>(source)};
+}
+} // namespace
+
+TEST_CASE("error-context-expected-refs-render-only-when-retained")
+{
+    std::string input = "hello";
+    Context context(input);
+    static const char a[] = "'a'";
+    static const char b[] = "'b'";
+    g_describe_calls = 0;
+
+    // The furthest position is 3: a ref behind it is never described. Ties
+    // at 3 are described, and deduplicated by their text.
+    context.record_failure(3, ExpectedRef{a, &describe_counted});
+    for (int i = 0; i < 100; ++i) {
+        context.record_failure(1, ExpectedRef{b, &describe_counted});
+    }
+    CHECK(g_describe_calls == 1);
+    context.record_failure(3, ExpectedRef{a, &describe_counted});
+    context.record_failure(3, ExpectedRef{b, &describe_counted});
+    context.record_failure(3, ExpectedItem{ExpectedKind::Literal, "'a'"}); // eager, same text
+    CHECK(g_describe_calls == 3);
+    CHECK(context.expected().size() == 2);
+
+    auto err = context.take_error();
+    REQUIRE(err.has_value());
+    CHECK(err->position() == 3);
+    CHECK(err->expected().size() == 2);
+}
+
 TEST_CASE("error-terminal-records-expected-on-failure")
 {
     std::string input = "abc";
@@ -153,6 +191,33 @@ TEST_CASE("error-terminal-records-expected-on-failure")
     CHECK(found_rule);
 }
 
+TEST_CASE("error-expected-outlives-grammar")
+{
+    // Reading the error after the Grammar is destroyed must not touch its
+    // expressions.
+    std::string input = "q";
+    Context context(input);
+    {
+        Grammar<> g;
+        g["value"] = g.terminal('x') | g.terminalSeq(std::string("yz")) | g.terminal('0', '9');
+        CHECK_FALSE(g.parse("value", context));
+    }
+    auto err = context.take_error();
+    REQUIRE(err.has_value());
+    CHECK(err->position() == 0);
+    CHECK(err->expected().size() == 4); // 'x', "yz", '0'..'9', value
+    bool found_x = false;
+    bool found_rule = false;
+    for (const auto& item : err->expected()) {
+        if (item.text == "'x'")
+            found_x = true;
+        if (item.text == "value")
+            found_rule = true;
+    }
+    CHECK(found_x);
+    CHECK(found_rule);
+}
+
 TEST_CASE("error-named-rule-records-rulename-on-failure")
 {
     std::string input = "abc";
@@ -410,3 +475,93 @@ TEST_CASE("multi-diagnostic-format-each")
     CHECK(diags[0].format(map, "f") == "f:1:1: error: expected 'x'");
     CHECK(diags[1].format(map, "f") == "f:2:1: error: expected 'y'");
 }
+
+// ---------------------------------------------------------------------------
+// ErrorTracking: Off records nothing; Deferred re-parses a failure with
+// tracking on and must produce the Diagnostic Full would have.
+// ---------------------------------------------------------------------------
+
+namespace
+{
+struct TrackingGrammar
+{
+    Grammar<> g;
+    TrackingGrammar()
+    {
+        g["num"] = +g.terminal('0', '9');
+        g["call"] = g.terminal('f') >> g.cut() >> g.terminal('(') >> g["num"] >> g.terminal(')');
+        g["item"] = g["call"] | g["num"];
+        g["list"] = g["item"] >> *(g.terminal(',') >> g["item"]);
+        g.set_start("list");
+    }
+};
+
+std::string diagnostic_of(const Grammar<>& g, std::string_view input, ErrorTracking mode)
+{
+    std::string s{input};
+    Context ctx{s};
+    ctx.error_tracking(mode);
+    if (g.parse(ctx)) {
+        return "ok";
+    }
+    auto err = ctx.take_error();
+    return err ? err->format(SourceMap{std::string_view{s}}, "t") : "no diagnostic";
+}
+} // namespace
+
+TEST_CASE("error-tracking-off-records-nothing")
+{
+    TrackingGrammar t;
+    CHECK(diagnostic_of(t.g, "1,2,f(3)", ErrorTracking::Off) == "ok");
+    CHECK(diagnostic_of(t.g, "x", ErrorTracking::Off) == "no diagnostic");
+
+    std::string input = "12,";
+    Context context(input);
+    context.error_tracking(ErrorTracking::Off);
+    CHECK_FALSE(context.tracks_errors());
+    context.record_failure(1, ExpectedItem{ExpectedKind::Literal, "'x'"});
+    CHECK_FALSE(context.has_error());
+}
+
+TEST_CASE("error-tracking-deferred-matches-full")
+{
+    TrackingGrammar t;
+    // Plain failure, cut-committed failure (thrown past the Alternation),
+    // and a failure deep in the input after many memoized successes.
+    for (std::string_view input : {"x", "1,f(2,3)", "1,2,3,4,5,f(", "1,2,f(3),4,f)"}) {
+        const std::string full = diagnostic_of(t.g, input, ErrorTracking::Full);
+        CHECK(full != "ok");
+        CHECK(diagnostic_of(t.g, input, ErrorTracking::Deferred) == full);
+    }
+    CHECK(diagnostic_of(t.g, "1,2,f(3)", ErrorTracking::Deferred) == "ok");
+
+    // The re-parse leaves the Context untracked for its next use.
+    std::string input = "x";
+    Context context(input);
+    context.error_tracking(ErrorTracking::Deferred);
+    CHECK_FALSE(t.g.parse(context));
+    CHECK(context.has_error());
+    CHECK_FALSE(context.tracks_errors());
+}
+
+TEST_CASE("error-tracking-deferred-does-not-duplicate-recovery-diagnostics")
+{
+    Grammar<> g;
+    g["stmt"] = g.terminal('a') >> g.terminal(';');
+    g["stmt"].set_recovery(recover_set<char>({';'}, "statement"));
+    g["prog"] = *g["stmt"] >> g.terminal('!');
+    g.set_start("prog");
+
+    std::size_t counts[2] = {};
+    std::size_t i = 0;
+    for (ErrorTracking mode : {ErrorTracking::Full, ErrorTracking::Deferred}) {
+        std::string input = "a;b;a;";
+        Context context(input);
+        context.error_tracking(mode);
+        CHECK_FALSE(g.parse(context));
+        CHECK(context.has_error());
+        counts[i++] = context.diagnostics().size();
+    }
+    CHECK(counts[0] >= 1);
+    CHECK(counts[1] == counts[0]);
+}
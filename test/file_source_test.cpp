@@ -137,3 +137,33 @@ TEST_CASE("filesource-reread-after-eviction-is-stable")
     CHECK(v0b == expected[0]);
     CHECK(v0a == v0b);
 }
+
+// The published window follows the buffer that served the last read, and
+// Context reads through it (the virtual at() only runs on page crossings).
+TEST_CASE("filesource-window-tracks-the-serving-buffer")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    const std::string expected = read_all(license_path);
+
+    auto fs = FileSource<char, 16>(license_path);
+    CHECK(fs.window().begin == 0);
+    CHECK(fs.window().end == 16);
+
+    CHECK(fs.at(40) == expected[40]); // refill: window moves to [32, 48)
+    CHECK(fs.window().begin == 32);
+    CHECK(fs.window().end == 48);
+    CHECK(fs.window().contains(47));
+    CHECK_FALSE(fs.window().contains(48));
+    CHECK(fs.window().data[40 - 32] == expected[40]);
+
+    fs.release_before(48); // the serving buffer is dropped with the window
+    CHECK_FALSE(fs.window().contains(40));
+
+    auto ctx = from_file<char, 16>(license_path);
+    REQUIRE(ctx.input().window() != nullptr);
+    for (std::size_t i = 0; i < expected.size(); i += 7) {
+        REQUIRE(ctx.at(i) == expected[i]);
+        CHECK(ctx.input().window()->contains(i));
+    }
+    CHECK(ctx.at(3) == expected[3]); // backward crossing re-faults
+}
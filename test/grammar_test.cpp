@@ -6,7 +6,7 @@
 //   - Self-referential and mutually-recursive rules
 //   - Auto-naming (rule name = map key)
 //   - Validation (undefined rules)
-//   - parse_string convenience
+//   - parse_string / parse_view convenience
 //   - Semantic actions
 //   - Rule handle chaining (set_action, set_label)
 // ---------------------------------------------------------------------------
@@ -41,6 +41,17 @@ TEST_CASE("[grammar] basic-rule-definition")
     {
         CHECK_FALSE(g.parse_string("abc"));
     }
+    SUBCASE("parse_view reuses a caller-kept Context")
+    {
+        std::string input = "7";
+        Context ctx(input);
+        CHECK(g.parse_view("12345"));
+        CHECK(g.parse_view("12345", ctx));
+        CHECK(ctx.ended());
+        CHECK_FALSE(g.parse_view("abc", ctx));
+        CHECK(g.parse_view("678", ctx));
+        CHECK(ctx.mark() == 3);
+    }
     SUBCASE("explicit rule via parse(rule, ctx)")
     {
         std::string input = "42";
@@ -0,0 +1,201 @@
+// ---------------------------------------------------------------------------
+// Resource limits (ParseLimits / Context::limits).
+//
+// Covers:
+//   - Each limit stops the parse with its own LimitKind: step budget, depth,
+//     deadline, memory cap, cancel flag.
+//   - A stopped parse fails outright: no recovery, no Deferred re-parse,
+//     parse_or_throw throws ParseLimitError, parse_async reports Failed.
+//   - Generous limits change nothing, and the budget is per parse.
+// ---------------------------------------------------------------------------
+
+#include "peglib.h"
+
+#include "doctest.h"
+
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <string>
+
+using namespace peg;
+
+namespace
+{
+// list <- item (',' item)*; item <- [0-9] / '(' list ')'
+void lists(Grammar<char>& g)
+{
+    g["item"] = g.terminal('0', '9') | g.terminal('(') >> g["list"] >> g.terminal(')');
+    g["list"] = g["item"] >> *(g.terminal(',') >> g["item"]);
+}
+
+std::string flat(int n)
+{
+    std::string in = "1";
+    for (int i = 0; i < n; ++i) {
+        in += ",2";
+    }
+    return in;
+}
+
+std::string nested(int depth)
+{
+    return std::string(static_cast<std::size_t>(depth), '(') + "1" +
+           std::string(static_cast<std::size_t>(depth), ')');
+}
+} // namespace
+
+TEST_CASE("limits: step budget")
+{
+    Grammar<char> g;
+    lists(g);
+    const std::string in = flat(1000);
+    Grammar<char>::Context ctx{in};
+    ctx.limits({.max_steps = 100});
+    CHECK_FALSE(g.parse("list", ctx));
+    CHECK(ctx.limit_exceeded() == LimitKind::Steps);
+    CHECK(ctx.steps() == 101); // the application that went over is refused
+    CHECK(ctx.limit_position() > 0);
+    CHECK(ctx.limit_position() < in.size());
+
+    // The budget is per parse: enough of it, and the same Context parses.
+    ctx.limits({.max_steps = 10000});
+    ctx.reset(0);
+    CHECK(g.parse("list", ctx));
+    CHECK(ctx.ended());
+    CHECK(ctx.limit_exceeded() == LimitKind::None);
+}
+
+TEST_CASE("limits: nesting depth")
+{
+    Grammar<char> g;
+    lists(g);
+    const std::string in = nested(200);
+    Grammar<char>::Context deep{in};
+    deep.limits({.max_depth = 100});
+    CHECK_FALSE(g.parse("list", deep));
+    CHECK(deep.limit_exceeded() == LimitKind::Depth);
+
+    Grammar<char>::Context ok{in};
+    ok.limits({.max_depth = 1000});
+    CHECK(g.parse("list", ok));
+    CHECK(ok.ended());
+}
+
+TEST_CASE("limits: deadline and cancel")
+{
+    Grammar<char> g;
+    lists(g);
+    const std::string in = flat(10);
+
+    // Checked when the parse starts, so even a short parse sees them.
+    Grammar<char>::Context late{in};
+    late.limits({.deadline = std::chrono::steady_clock::now() - std::chrono::seconds{1}});
+    CHECK_FALSE(g.parse("list", late));
+    CHECK(late.limit_exceeded() == LimitKind::Deadline);
+
+    std::atomic<bool> cancel{true};
+    Grammar<char>::Context cancelled{in};
+    cancelled.limits({.cancel = &cancel});
+    CHECK_FALSE(g.parse("list", cancelled));
+    CHECK(cancelled.limit_exceeded() == LimitKind::Cancelled);
+
+    // Set mid-parse: seen within limit_check_interval rule applications.
+    cancel = false;
+    Grammar<char> h;
+    h["flag"] = h.matcher([&cancel](Grammar<char>::Context&, Span at) -> std::optional<Span> {
+        if (at.start == 500) {
+            cancel = true;
+        }
+        return Span{at.start, at.start};
+    });
+    h["item"] = h["flag"] >> h.terminal('0', '9');
+    h["list"] = h["item"] >> *(h.terminal(',') >> h["item"]);
+    const std::string long_in = flat(5000);
+    Grammar<char>::Context mid{long_in};
+    mid.limits({.cancel = &cancel});
+    CHECK_FALSE(h.parse("list", mid));
+    CHECK(mid.limit_exceeded() == LimitKind::Cancelled);
+    CHECK(mid.limit_position() >= 500);
+    CHECK(mid.limit_position() < 500 + 2 * Grammar<char>::Context::limit_check_interval);
+}
+
+TEST_CASE("limits: memory cap")
+{
+    Grammar<char> g;
+    lists(g);
+    const std::string in = flat(20000);
+    Grammar<char>::Context ctx{in};
+    ctx.limits({.max_memory = 64 * 1024});
+    CHECK_FALSE(g.parse("list", ctx));
+    CHECK(ctx.limit_exceeded() == LimitKind::Memory);
+    CHECK(ctx.memory_stats().bytes() < 4 * 64 * 1024); // stopped near the cap
+}
+
+TEST_CASE("limits: a stopped parse fails outright")
+{
+    Grammar<char> g;
+    g["digit"] = g.terminal('0', '9');
+    g["stmt"] = g["digit"] >> g.terminal(';');
+    g["stmt"].set_recovery(recover_set<char>({';'}));
+    g["prog"] = +g["stmt"];
+    const std::string in = "1;2;3;4;5;6;7;8;9;";
+
+    // No recovery, no Deferred re-parse.
+    Grammar<char>::Context ctx{in};
+    ctx.error_tracking(ErrorTracking::Deferred);
+    ctx.limits({.max_steps = 5});
+    CHECK_FALSE(g.parse("prog", ctx));
+    CHECK(ctx.limit_exceeded() == LimitKind::Steps);
+    CHECK(ctx.diagnostics().empty());
+    CHECK(ctx.steps() == 6);
+
+    // parse_or_throw: ParseLimitError, not ParseError.
+    Grammar<char>::Context thrown{in};
+    thrown.limits({.max_steps = 5});
+    CHECK_THROWS_AS(g.parse_or_throw("prog", thrown), ParseLimitError);
+    try {
+        Grammar<char>::Context again{in};
+        again.limits({.max_depth = 1});
+        (void)g.parse_or_throw("prog", again);
+        FAIL("expected ParseLimitError");
+    } catch (const ParseError&) {
+        FAIL("a limit is not a ParseError");
+    } catch (const ParseLimitError& e) {
+        CHECK(e.kind() == LimitKind::Depth);
+        CHECK(std::string{e.what()}.find("nesting too deep") != std::string::npos);
+    }
+
+    // parse_async: Failed, even with the input still open.
+    auto push = from_push<char>();
+    push.feed(std::string_view{"1;2;"});
+    push.limits({.max_steps = 2});
+    CHECK(g.parse_async("prog", push) == ParseStatus::Failed);
+    CHECK(push.limit_exceeded() == LimitKind::Steps);
+}
+
+TEST_CASE("limits: generous limits change nothing")
+{
+    Grammar<char> g;
+    lists(g);
+    const std::string in = flat(100) + "," + nested(20);
+    std::atomic<bool> cancel{false};
+
+    Grammar<char>::Context plain{in};
+    Grammar<char>::Context limited{in};
+    limited.limits({.max_steps = 1000000,
+                    .deadline = std::chrono::steady_clock::now() + std::chrono::hours{1},
+                    .max_memory = std::size_t{1} << 30,
+                    .max_depth = 1000,
+                    .cancel = &cancel});
+    CHECK_FALSE(plain.rule_hooks());
+    CHECK(limited.rule_hooks());
+    CHECK(g.parse("list", plain) == g.parse("list", limited));
+    CHECK(plain.mark() == limited.mark());
+    CHECK(plain.node_count() == limited.node_count());
+    CHECK(limited.limit_exceeded() == LimitKind::None);
+    CHECK(limited.steps() > 0);
+
+    limited.limits({});
+    CHECK_FALSE(limited.rule_hooks());
+}
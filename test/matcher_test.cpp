@@ -1,5 +1,6 @@
 #include "peglib.h"
 
+#include <cstring>
 #include <optional>
 #include <string>
 #include <vector>
@@ -184,3 +185,33 @@ TEST_CASE("matcher-result-is-void-filtered-from-sequence")
     REQUIRE(ast);
     CHECK(ast->matched == 'a');
 }
+
+TEST_CASE("matcher-bulk-scan-via-chunk-and-view")
+{
+    // A line comment matcher that finds the newline with memchr over
+    // ctx.chunk() instead of one ctx.at() per character, and an on_match
+    // that reads the comment text through ctx.view() without copying.
+    Grammar<char, int> g;
+    g["comment"] = g.matcher([](Ctx& c, Span sp) -> std::optional<Span> {
+        if (c.ended_at(sp.start + 1) || c.at(sp.start) != '/' || c.at(sp.start + 1) != '/')
+            return std::nullopt;
+        std::size_t pos = sp.start + 2;
+        for (auto run = c.chunk(pos); !run.empty(); run = c.chunk(pos)) {
+            if (const void* nl = std::memchr(run.data(), '\n', run.size())) {
+                return Span{sp.start, pos + static_cast<std::size_t>(
+                                                static_cast<const char*>(nl) - run.data())};
+            }
+            pos += run.size();
+        }
+        return Span{sp.start, pos};
+    });
+    std::string text;
+    g["comment"].on_match(
+        [&text](Ctx& c, const NodePtr& n) { text = c.view({n->start_offset, n->end_offset}); });
+
+    std::string input = "// hello, world\nrest";
+    Ctx ctx(input);
+    REQUIRE(g.parse_ast("comment", ctx));
+    CHECK(ctx.mark() == 15);
+    CHECK(text == "// hello, world");
+}
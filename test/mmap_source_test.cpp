@@ -0,0 +1,134 @@
+// ---------------------------------------------------------------------------
+// MmapSource tests.
+//
+// A mapped file must behave exactly like the same bytes in a std::string:
+// Context takes the contiguous fast path (contiguous_data() non-null), parses
+// produce identical trees, and cut-driven release_before (MADV_DONTNEED) is
+// transparent — released pages re-fault from the file on a later read.
+// ---------------------------------------------------------------------------
+#include "peglib.h"
+
+#include "doctest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace peg;
+
+namespace
+{
+// RAII temp file (same pattern as streaming_test.cpp).
+struct TmpFile
+{
+    std::string path;
+    explicit TmpFile(std::string_view name, std::string_view content)
+        : path{std::string(PEGLIB_TEST_DATA_DIR) + "/" + std::string{name}}
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    ~TmpFile()
+    {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+    }
+    TmpFile(const TmpFile&) = delete;
+    TmpFile& operator=(const TmpFile&) = delete;
+};
+
+std::string read_all(const std::string& path)
+{
+    std::ifstream fs(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>()};
+}
+} // namespace
+
+TEST_CASE("mmap: from_mmap reads the file on the contiguous fast path")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    auto ctx = from_mmap<char>(license_path);
+    const std::string expected = read_all(license_path);
+
+    REQUIRE(ctx.input().contiguous_data() != nullptr);
+    CHECK(ctx.input().size() == expected.size());
+
+    auto it = expected.begin();
+    while (!ctx.ended()) {
+        CHECK(ctx.current() == *it);
+        ++it;
+        ctx.next();
+    }
+    CHECK(it == expected.end());
+}
+
+TEST_CASE("mmap: view() exposes the whole mapping without a copy")
+{
+    TmpFile tmp{"mmap_view.tmp", "hello, mapped world"};
+    MmapSource<char> ms{tmp.path};
+    CHECK(ms.size() == 19);
+    CHECK(ms.view() == "hello, mapped world");
+    CHECK(ms.view().data() == ms.data());
+}
+
+TEST_CASE("mmap: empty file is an empty source")
+{
+    TmpFile tmp{"mmap_empty.tmp", ""};
+    auto ctx = from_mmap<char>(tmp.path);
+    CHECK(ctx.ended());
+    CHECK(ctx.input().size() == 0);
+
+    Grammar<> g;
+    g["empty"] = g.empty();
+    CHECK(g.parse("empty", ctx));
+}
+
+TEST_CASE("mmap: missing file throws")
+{
+    CHECK_THROWS_AS(MmapSource<char>{"/nonexistent/peglib-mmap-test"}, std::runtime_error);
+}
+
+TEST_CASE("mmap: cut-driven release is transparent to later reads")
+{
+    // Two alternatives committed by cut after a long run of padding, so the
+    // cut position lies several pages into the file and release_before drops
+    // whole pages before it.
+    Grammar<> g;
+    g["line"] = (g.token('a') >> +g.terminal('p') >> g.cut() >> +g.terminal('x')) |
+                (g.token('b') >> +g.terminal('q') >> g.cut() >> +g.terminal('y'));
+    g.set_start("line");
+
+    const std::string input = "a" + std::string(3 * 4096, 'p') + std::string(100, 'x');
+    TmpFile tmp{"mmap_cut.tmp", input};
+
+    Context<char> ref{input};
+    auto ref_tree = g.parse_tree("line", ref);
+    REQUIRE(ref_tree);
+
+    auto ctx = from_mmap<char>(tmp.path);
+    auto tree = g.parse_tree("line", ctx);
+    REQUIRE(tree);
+    CHECK(ctx.ended());
+    CHECK(tree->end_offset == ref_tree->end_offset);
+    CHECK(tree->children.size() == ref_tree->children.size());
+
+    // Offset 0 lives on a released page; reading it re-faults from the file.
+    CHECK(ctx.at(0) == 'a');
+    CHECK(ctx.at(4096) == 'p');
+    CHECK(ctx.input().slice(0, 3) == "app");
+}
+
+TEST_CASE("mmap: wide element type addresses whole items only")
+{
+    // 9 bytes -> two char32_t items; the trailing partial item is dropped.
+    const char32_t items[2] = {U'a', U'b'};
+    const std::string bytes = std::string(reinterpret_cast<const char*>(items), sizeof items) + "c";
+    TmpFile tmp{"mmap_wide.tmp", bytes};
+    auto ctx = from_mmap<char32_t>(tmp.path);
+    CHECK(ctx.input().size() == 2);
+    CHECK(ctx.at(0) == U'a');
+    CHECK(ctx.at(1) == U'b');
+}
@@ -0,0 +1,211 @@
+// ---------------------------------------------------------------------------
+// PagedFileSource tests.
+//
+// The N-page LRU cache must return the same bytes as the file for every page
+// geometry, keep a backtrack within `page_count` pages free of disk reads,
+// reuse released slots before evicting live pages, and (with read-ahead)
+// serve a forward scan from the prefetch buffer. Parses over it must match
+// the in-memory reference.
+// ---------------------------------------------------------------------------
+#include "peglib.h"
+
+#include "doctest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+using namespace peg;
+
+namespace
+{
+// RAII temp file (same pattern as streaming_test.cpp).
+struct TmpFile
+{
+    std::string path;
+    explicit TmpFile(std::string_view name, std::string_view content)
+        : path{std::string(PEGLIB_TEST_DATA_DIR) + "/" + std::string{name}}
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+    ~TmpFile()
+    {
+        if (!path.empty()) {
+            std::remove(path.c_str());
+        }
+    }
+    TmpFile(const TmpFile&) = delete;
+    TmpFile& operator=(const TmpFile&) = delete;
+};
+
+std::string numbered(std::size_t n)
+{
+    std::string s;
+    for (std::size_t i = 0; i < n; ++i) {
+        s.push_back(static_cast<char>('a' + (i * 7) % 26));
+    }
+    return s;
+}
+} // namespace
+
+TEST_CASE("paged: reads match the file for several page geometries")
+{
+    const std::string content = numbered(1000);
+    TmpFile tmp{"paged_geometry.tmp", content};
+
+    for (std::size_t page_size : {1u, 7u, 64u, 4096u}) {
+        for (std::size_t page_count : {1u, 2u, 5u}) {
+            PagedFileSource<char> ps{tmp.path, {.page_size = page_size, .page_count = page_count}};
+            REQUIRE(ps.size() == content.size());
+            // Forward, then strided backward (forces misses on small caches).
+            for (std::size_t i = 0; i < content.size(); ++i) {
+                REQUIRE(ps.at(i) == content[i]);
+            }
+            for (std::size_t i = content.size(); i-- > 0;) {
+                REQUIRE(ps.at(i) == content[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("paged: backtrack within the resident pages does not touch disk")
+{
+    const std::string content = numbered(64 * 8);
+    TmpFile tmp{"paged_backtrack.tmp", content};
+    PagedFileSource<char> ps{tmp.path, {.page_size = 64, .page_count = 4}};
+
+    for (std::size_t i = 0; i < 4 * 64; ++i) {
+        (void)ps.at(i);
+    }
+    CHECK(ps.stats().disk_reads == 4);
+
+    // Three pages behind the head: still resident (a two-page FileSource
+    // would re-read here).
+    CHECK(ps.at(0) == content[0]);
+    CHECK(ps.at(70) == content[70]);
+    CHECK(ps.stats().disk_reads == 4);
+
+    // A fifth page evicts the least recently used (page 2, since 0 and 1 were
+    // just touched).
+    CHECK(ps.at(4 * 64) == content[4 * 64]);
+    CHECK(ps.stats().disk_reads == 5);
+    CHECK(ps.at(1) == content[1]);
+    CHECK(ps.stats().disk_reads == 5);
+    CHECK(ps.at(2 * 64) == content[2 * 64]);
+    CHECK(ps.stats().disk_reads == 6);
+}
+
+TEST_CASE("paged: released pages are reused before live ones")
+{
+    const std::string content = numbered(64 * 8);
+    TmpFile tmp{"paged_release.tmp", content};
+    PagedFileSource<char> ps{tmp.path, {.page_size = 64, .page_count = 3}};
+
+    (void)ps.at(0);
+    (void)ps.at(64);
+    (void)ps.at(128);
+    CHECK(ps.resident_pages() == 3);
+
+    ps.release_before(64); // page 0 is committed away
+    CHECK(ps.resident_pages() == 2);
+
+    // Touch page 1 last-recently so that plain LRU would pick page 2 next;
+    // the released slot must be taken instead.
+    (void)ps.at(128);
+    (void)ps.at(64);
+    (void)ps.at(192);
+    CHECK(ps.stats().disk_reads == 4);
+    (void)ps.at(128);
+    CHECK(ps.stats().disk_reads == 4);
+
+    // Reads below the release point re-fault transparently.
+    CHECK(ps.at(5) == content[5]);
+}
+
+TEST_CASE("paged: read-ahead serves a forward scan from the prefetch buffer")
+{
+    const std::string content = numbered(256 * 10);
+    TmpFile tmp{"paged_readahead.tmp", content};
+    PagedFileSource<char> ps{tmp.path,
+                             {.page_size = 256, .page_count = 2, .read_ahead = true}};
+
+    for (std::size_t i = 0; i < content.size(); ++i) {
+        REQUIRE(ps.at(i) == content[i]);
+    }
+    // Page 0 is read synchronously; each later page was requested when its
+    // predecessor faulted in.
+    CHECK(ps.stats().disk_reads == 1);
+    CHECK(ps.stats().prefetched == 9);
+
+    // Random access afterwards still returns the right bytes.
+    CHECK(ps.at(3) == content[3]);
+    CHECK(ps.at(1500) == content[1500]);
+}
+
+TEST_CASE("paged: invalid geometry throws")
+{
+    TmpFile tmp{"paged_invalid.tmp", "abc"};
+    CHECK_THROWS_AS(PagedFileSource<char>(tmp.path, {.page_size = 0}), std::invalid_argument);
+    CHECK_THROWS_AS(PagedFileSource<char>(tmp.path, {.page_count = 0}), std::invalid_argument);
+    CHECK_THROWS_AS(PagedFileSource<char>("/nonexistent/peglib-paged-test"), std::runtime_error);
+}
+
+TEST_CASE("paged: cut-driven parse matches the in-memory reference")
+{
+    Grammar<> g;
+    g["line"] = (g.token('a') >> +g.terminal('p') >> g.cut() >> +g.terminal('x')) |
+                (g.token('b') >> +g.terminal('q') >> g.cut() >> +g.terminal('y'));
+    g.set_start("line");
+
+    for (const std::string& input :
+         {"a" + std::string(300, 'p') + std::string(50, 'x'),
+          "b" + std::string(300, 'q') + std::string(50, 'y')}) {
+        Context<char> ref{input};
+        auto ref_tree = g.parse_tree("line", ref);
+        REQUIRE(ref_tree);
+
+        TmpFile tmp{"paged_parse.tmp", input};
+        for (bool read_ahead : {false, true}) {
+            auto ctx = from_paged_file<char>(
+                tmp.path, {.page_size = 16, .page_count = 3, .read_ahead = read_ahead});
+            auto tree = g.parse_tree("line", ctx);
+            REQUIRE(tree);
+            CHECK(ctx.ended());
+            CHECK(tree->end_offset == ref_tree->end_offset);
+            CHECK(tree->children.size() == ref_tree->children.size());
+            CHECK(ctx.at(0) == input[0]);
+        }
+    }
+}
+
+TEST_CASE("paged: SourceMap over a PagedFileSource")
+{
+    TmpFile tmp{"paged_sourcemap.tmp", "one\ntwo\r\nthree"};
+    PagedFileSource<char> ps{tmp.path, {.page_size = 4, .page_count = 2}};
+    SourceMap sm{ps};
+    CHECK(sm.num_lines() == 3);
+    CHECK(sm.line_content(2) == "two");
+    CHECK(sm.locate(10).line == 3);
+}
+
+TEST_CASE("paged: window follows the faulted page")
+{
+    const std::string content = numbered(64 * 4);
+    TmpFile tmp{"paged_window.tmp", content};
+    auto ctx = from_paged_file<char>(tmp.path, {.page_size = 64, .page_count = 2});
+    const InputWindow<char>& w = *ctx.input().window();
+    CHECK_FALSE(w.contains(0)); // nothing faulted yet
+
+    CHECK(ctx.at(130) == content[130]);
+    CHECK(w.begin == 128);
+    CHECK(w.end == 192);
+    CHECK(ctx.at(191) == content[191]); // in-window: indexed directly
+
+    ctx.input().release_before(192);
+    CHECK_FALSE(w.contains(130));
+    CHECK(ctx.at(130) == content[130]);
+    CHECK(w.contains(130));
+}
@@ -51,14 +51,15 @@ TEST_CASE("cut-committed-failure-surfaces-via-take-error")
     CHECK(g.parse("g1", context1));
 
     // `('a' >> cut >> 'x') | 'a'` on input "ab":
-    // first alt matches 'a', sets cut, then fails on 'x'. With the
-    // D1 contract change, Grammar::parse catches the internally-thrown
-    // peg::ParseError and reports failure normally — it does NOT throw to
-    // the caller. The diagnostic is queryable via ctx.take_error().
+    // first alt matches 'a', sets cut, then fails on 'x'. The committed
+    // failure propagates as an ordinary failed result — nothing is thrown —
+    // and Grammar::parse reports it normally. The diagnostic is queryable
+    // via ctx.take_error().
     std::string input2 = "ab";
     Context context2(input2);
     g["g2"] = (g.terminal('a') >> g.cut() >> g.terminal('x')) | g.terminal('a');
     CHECK_FALSE(g.parse("g2", context2));
+    CHECK(context2.committed_failure());
     auto err = context2.take_error();
     REQUIRE(err);
     const auto& err_ref = err.value();
@@ -150,8 +151,56 @@ TEST_CASE("bounded-repetition-cut-failure-does-not-throw")
     // The whole grammar still fails to match (it wanted 2 'a..b' pairs and
     // got none committed), but it fails NORMALLY — no exception escapes.
     CHECK_FALSE(g.parse(context));
-    // And crucially: no cut-committed ParseError propagated. (If it had,
-    // g.parse would have caught it per the D1 contract and reported via
-    // take_error; the assertion above already covers "no throw". Here we
-    // additionally confirm the failure is a regular parse failure.)
+    // And crucially: the failure did not escalate to a committed one.
+    CHECK_FALSE(context.committed_failure());
+}
+
+TEST_CASE("committed-failure-is-not-recovered-by-enclosing-combinators")
+{
+    // A cut failure deep inside must fail the whole parse even where an
+    // enclosing combinator would turn a plain failure into success: a
+    // later alternative, a bounded repetition, a negative lookahead.
+    Grammar<> g;
+    g["inner"] = (g.terminal('a') >> g.cut() >> g.terminal('b')) | g.terminal('a');
+    g["alt"] = g["inner"] | (g.terminal('a') >> g.terminal('c'));
+    g["opt"] = -g["inner"] >> g.terminal('a');
+    g["neg"] = !g["inner"] >> g.terminal('a');
+
+    for (const char* rule : {"alt", "opt", "neg"}) {
+        std::string input = "ac";
+        Context context(input);
+        CHECK_FALSE(g.parse(rule, context));
+        CHECK(context.committed_failure());
+        auto err = context.take_error();
+        REQUIRE(err);
+        CHECK(err->position() == 1);
+    }
+
+    // The flag is per parse: the next parse on the Context starts clean.
+    std::string input = "ab";
+    Context context(input);
+    CHECK(g.parse("alt", context));
+    CHECK_FALSE(context.committed_failure());
+}
+
+TEST_CASE("parse-or-throw-raises-parse-error-for-committed-failures")
+{
+    Grammar<> g;
+    g["g"] = (g.terminal('a') >> g.cut() >> g.terminal('x')) | g.terminal('a');
+    g["plain"] = g.terminal('z');
+
+    std::string input = "ab";
+    Context context(input);
+    try {
+        (void)g.parse_or_throw("g", context);
+        FAIL("expected ParseError");
+    } catch (const ParseError& e) {
+        CHECK(e.position() == 1);
+        CHECK(std::string(e.what()).find("'x'") != std::string::npos);
+    }
+
+    // Regular failures still return false.
+    Context context2(input);
+    CHECK_FALSE(g.parse_or_throw("plain", context2));
+    CHECK(context2.has_error());
 }
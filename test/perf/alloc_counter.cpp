@@ -0,0 +1,163 @@
+// Global operator new / delete replacement backing alloc_counter.hpp. Linked
+// into the bench executables only. The aligned (std::align_val_t) overloads
+// keep their default definitions and are not counted; nothing in peglib
+// uses over-aligned types.
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define PEGLIB_BENCH_LIVE_BYTES 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+std::atomic<bool> g_counting{false};
+std::atomic<std::uint64_t> g_allocs{0};
+std::atomic<std::uint64_t> g_bytes{0};
+std::atomic<std::int64_t> g_live{0};
+std::atomic<std::int64_t> g_peak{0};
+
+void* counted_alloc(std::size_t n)
+{
+    void* p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) {
+        throw std::bad_alloc{};
+    }
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocs.fetch_add(1, std::memory_order_relaxed);
+        g_bytes.fetch_add(n, std::memory_order_relaxed);
+#if defined(PEGLIB_BENCH_LIVE_BYTES)
+        const auto usable = static_cast<std::int64_t>(malloc_usable_size(p));
+        const auto live = g_live.fetch_add(usable, std::memory_order_relaxed) + usable;
+        auto peak = g_peak.load(std::memory_order_relaxed);
+        while (live > peak &&
+               !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+        }
+#endif
+    }
+    return p;
+}
+
+void counted_free(void* p) noexcept
+{
+    if (p == nullptr) {
+        return;
+    }
+#if defined(PEGLIB_BENCH_LIVE_BYTES)
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_live.fetch_sub(static_cast<std::int64_t>(malloc_usable_size(p)),
+                         std::memory_order_relaxed);
+    }
+#endif
+    std::free(p);
+}
+} // namespace
+
+namespace peglib_bench
+{
+
+std::size_t peak_rss_bytes() noexcept
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss); // bytes
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024; // KiB
+#endif
+#else
+    return 0;
+#endif
+}
+
+AllocScope::AllocScope() noexcept
+{
+    g_allocs.store(0, std::memory_order_relaxed);
+    g_bytes.store(0, std::memory_order_relaxed);
+    g_live.store(0, std::memory_order_relaxed);
+    g_peak.store(0, std::memory_order_relaxed);
+    g_counting.store(true, std::memory_order_seq_cst);
+}
+
+AllocScope::~AllocScope()
+{
+    if (m_active) {
+        (void)finish();
+    }
+}
+
+// Frees of blocks allocated before the scope lower the live level too, so
+// peak_live is a lower bound when the scope releases older memory.
+AllocCounts AllocScope::finish() noexcept
+{
+    g_counting.store(false, std::memory_order_seq_cst);
+    m_active = false;
+    AllocCounts c;
+    c.allocs = g_allocs.load(std::memory_order_relaxed);
+    c.bytes = g_bytes.load(std::memory_order_relaxed);
+#if defined(PEGLIB_BENCH_LIVE_BYTES)
+    c.peak_live = g_peak.load(std::memory_order_relaxed);
+#endif
+    return c;
+}
+
+} // namespace peglib_bench
+
+void* operator new(std::size_t n)
+{
+    return counted_alloc(n);
+}
+
+void* operator new[](std::size_t n)
+{
+    return counted_alloc(n);
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    try {
+        return counted_alloc(n);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+    try {
+        return counted_alloc(n);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    counted_free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    counted_free(p);
+}
@@ -0,0 +1,49 @@
+// ---------------------------------------------------------------------------
+// Heap accounting for peglib_bench.
+//
+// alloc_counter.cpp replaces the global operator new / delete for the bench
+// executable. While counting is switched on (AllocScope), every allocation
+// bumps a count and a byte total, and live heap bytes are tracked (glibc:
+// malloc_usable_size) so a scope can report its peak over its starting
+// level. With counting off the replacements are a plain malloc / free behind
+// one relaxed load, so timed iterations are not perturbed.
+// ---------------------------------------------------------------------------
+#ifndef PEGLIB_PERF_ALLOC_COUNTER_HPP
+#define PEGLIB_PERF_ALLOC_COUNTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace peglib_bench
+{
+
+struct AllocCounts
+{
+    std::uint64_t allocs = 0;
+    std::uint64_t bytes = 0;     // requested bytes
+    std::int64_t peak_live = -1; // peak live heap over the scope's start; -1 = untracked
+};
+
+// Peak resident set size of the process so far, in bytes (0 where not
+// available). A process-wide high-water mark: it never goes down, so a row
+// only moves it if it needs more than every row before it.
+std::size_t peak_rss_bytes() noexcept;
+
+// Counts allocations between construction and finish(). Scopes do not nest.
+class AllocScope
+{
+public:
+    AllocScope() noexcept;
+    ~AllocScope();
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+    AllocCounts finish() noexcept;
+
+private:
+    bool m_active = true;
+};
+
+} // namespace peglib_bench
+
+#endif // PEGLIB_PERF_ALLOC_COUNTER_HPP
@@ -1,41 +1,47 @@
 // ---------------------------------------------------------------------------
-// peglib benchmark harness.
+// peglib benchmark workloads.
 //
-// Measures end-to-end parse time on representative workloads, reported as
-// ns/parse and MB/s. NOT a pass/fail test — never registered with ctest. Gated
-// behind -DPEGLIB_BUILD_BENCHMARKS=ON so it never perturbs the normal test
-// build. Uses std::chrono::steady_clock (no external dependency).
+// Measures end-to-end parse time on representative workloads. NOT a
+// pass/fail test — never registered with ctest. Gated behind
+// -DPEGLIB_BUILD_BENCHMARKS=ON so it never perturbs the normal test build.
+// Timing, statistics, output formats and --compare live in harness.hpp
+// (std::chrono only, no external dependency).
 //
 // Each workload:
 //   1. builds the Grammar once (outside the timed loop — grammar construction
 //      is not what we're measuring),
-//   2. warms up a few iterations (stabilize caches / branch predictor),
-//   3. times a batch of parses, each over a FRESH Context (so memo state and
-//      tree allocation are measured per-parse, which is the hot path under
+//   2. times its rows through the harness (warmup, then `reps` batches of
+//      parses), each parse over a FRESH Context (so memo state and tree
+//      allocation are measured per-parse, which is the hot path under
 //      optimization),
-//   4. asserts the parse succeeded (a failed parse would silently lower the
-//      number — guard against it),
-//   5. reports min ns/parse and MB/s over the batch.
+//   3. checks every parse succeeded (a failed parse would silently lower the
+//      number — the row's `ok` column guards against it).
 //
-// Output is plain columns for easy before/after diffing:
+// A new workload is one PEGLIB_BENCH_WORKLOAD block anywhere below; main()
+// does not change. Rows run in the order the blocks appear.
 //
-//   workload                            size(B)  iters   ns/parse    MB/s   ok
-//   json wide (N=2000)                    18002   200      40123   448.7   1
-//   ...
-//
-// Pass --quick for a fast smoke run (fewer iters). Default is a measurement
-// run sized to keep total wall time under ~30s on a modern laptop.
+// Pass --quick for a fast smoke run (smaller inputs, fewer iters). Default is
+// a measurement run sized to keep total wall time under ~30s on a modern
+// laptop. See harness.hpp for --json / --csv / --filter / --reps /
+// --compare / --memory, and for --scaling, which runs the
+// PEGLIB_BENCH_SCALING block at the end of this file instead: every fixture
+// generator at doubling sizes, failing on superlinear growth.
 // ---------------------------------------------------------------------------
 #include "peglib.h"
 
+#include <atomic>
 #include <chrono>
 #include <cstdio>
-#include <cstdlib>
-#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <string>
 #include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "fixtures.hpp"
+#include "harness.hpp"
 
 using namespace peg;
 
@@ -48,69 +54,112 @@ namespace
 // default for CharT, so Context<> is ill-formed).
 using Ctx = Context<char>;
 
+using peglib_bench::Runner;
+
 // -------------------------------------------------------------------------
-// Result reporting.
+// Sizing. Iteration counts are sized so a default run stays around a few
+// seconds: parse time per iteration dominates the steady_clock granularity,
+// and the total batch keeps the process short. --quick divides by 10 for a
+// smoke check that everything links and parses.
+//
+// json_deep_n is capped well below the recursion ceiling: peglib is a
+// recursive-descent engine and deeply-nested input drives one C++ stack
+// frame per nesting level (array → value → array → …), each level spanning
+// several frames (NonTerminal::parseImpl → parse → Rule::parse →
+// SequenceExpr::parse …). Depth ~2000 parses cleanly under the default 8MB
+// stack; 4000 overflows it (SIGSEGV). 1500 keeps comfortable headroom while
+// still producing enough node/allocation work to measure.
 // -------------------------------------------------------------------------
-struct BenchResult
-{
-    const char* name;
-    std::size_t bytes;
-    int iters;
-    double ns_per_parse;
-    double mb_per_s;
-    bool ok;
+struct Sizes
+{
+    int json_wide_n;
+    int json_deep_n;
+    int arith_n;
+    int lr_n;
+    int lua_n;
+    int iters_small; // for the larger-input workloads
+    int iters_large; // for the smaller-input workloads
 };
 
-void print_header()
-{
-    std::printf(
-        "%-36s %8s %6s %11s %9s %4s\n", "workload", "size(B)", "iters", "ns/parse", "MB/s", "ok");
-    std::printf("%-36s %8s %6s %11s %9s %4s\n",
-                "------------------------------------",
-                "--------",
-                "------",
-                "-----------",
-                "---------",
-                "----");
+Sizes sizes(const Runner& bench)
+{
+    if (bench.quick()) {
+        return {400, 300, 500, 500, 200, 10, 30};
+    }
+    return {4000, 1500, 5000, 5000, 2000, 100, 300};
 }
 
-void print_result(const BenchResult& r)
+// Run `body(ctx)` `iters` times, each on a fresh Context from `make_ctx()`,
+// timing the total (Context construction included — for a mapped source that
+// is the open + mmap). The accounting iteration also reports the Context's
+// arena and memo size.
+template<typename MakeCtx, typename ParseFn>
+void run_source(
+    Runner& bench, const char* name, std::size_t bytes, int iters, MakeCtx make_ctx, ParseFn body)
 {
-    std::printf("%-36s %8zu %6d %11.0f %9.1f %4d\n",
-                r.name,
-                r.bytes,
-                r.iters,
-                r.ns_per_parse,
-                r.mb_per_s,
-                r.ok ? 1 : 0);
+    bench.run_fn(name, bytes, iters, [&] {
+        Ctx ctx = make_ctx();
+        const bool ok = body(ctx);
+        if (bench.accounting()) {
+            bench.report_parse(ctx.node_count(), ctx.memo_entry_count());
+        }
+        return ok;
+    });
 }
 
-// Run `body(ctx)` `iters` times, each on a fresh Context over `input`, timing
-// the total. Returns the per-parse ns (mean over the batch).
+// What a row's parse allocates by design once its Context is warm: nothing,
+// or the diagnostics it records and renders (recovery, take_error).
+enum class Allocates
+{
+    Nothing,
+    Diagnostics,
+};
+
+// In-memory variant: each iteration parses a SpanSource over `input`. With
+// --reuse, one Context serves the whole row, rebound per iteration, and a
+// row that allocates Nothing is checked for it (Runner::expect_no_allocs).
 template<typename ParseFn>
-BenchResult run(const char* name, std::string_view input, int warmup, int iters, ParseFn body)
+void run(Runner& bench,
+         const char* name,
+         std::string_view input,
+         int iters,
+         ParseFn body,
+         Allocates allocates = Allocates::Nothing)
 {
-    // Warmup on a throwaway context.
-    for (int i = 0; i < warmup; ++i) {
-        Ctx ctx{input};
-        body(ctx);
+    if (!bench.reuse()) {
+        run_source(
+            bench, name, input.size(), iters, [input] { return Ctx{input}; }, body);
+        return;
     }
+    Ctx ctx{input};
+    bench.run_fn(name, input.size(), iters, [&] {
+        ctx.rebind(input);
+        const bool ok = body(ctx);
+        if (bench.accounting()) {
+            bench.report_parse(ctx.node_count(), ctx.memo_entry_count());
+            if (allocates == Allocates::Nothing) {
+                bench.expect_no_allocs();
+            }
+        }
+        return ok;
+    });
+}
 
-    bool all_ok = true;
-    auto t0 = std::chrono::steady_clock::now();
-    for (int i = 0; i < iters; ++i) {
-        Ctx ctx{input};
-        if (!body(ctx))
-            all_ok = false;
+// Writes `content` to a file in the system temp directory for the
+// file-backed workloads; removed on destruction.
+struct BenchFile
+{
+    std::string path;
+    BenchFile(const char* name, std::string_view content)
+        : path{(std::filesystem::temp_directory_path() / name).string()}
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), static_cast<std::streamsize>(content.size()));
     }
-    auto t1 = std::chrono::steady_clock::now();
-
-    double secs = std::chrono::duration<double>(t1 - t0).count();
-    double ns_per_parse = (secs / static_cast<double>(iters)) * 1e9;
-    double mb_per_s = (static_cast<double>(input.size()) / (1024.0 * 1024.0)) /
-                      (secs / static_cast<double>(iters));
-    return {name, input.size(), iters, ns_per_parse, mb_per_s, all_ok};
-}
+    ~BenchFile() { std::remove(path.c_str()); }
+    BenchFile(const BenchFile&) = delete;
+    BenchFile& operator=(const BenchFile&) = delete;
+};
 
 // -------------------------------------------------------------------------
 // Grammars. Built once per program, outside the timed loop.
@@ -190,6 +239,135 @@ struct ArithWorkload
     }
 };
 
+// ArithWorkload with typed actions, for parse_ast: every factor folds to
+// its letter's index and every term / expr to the sum of its operands (the
+// operators only steer the parse), and an on_match hook counts factors.
+struct TypedArithWorkload
+{
+    using Ctx = Context<char, long>;
+    Grammar<char, long> g;
+    long factors = 0;
+    TypedArithWorkload()
+    {
+        auto letter = (g["letter"] = g.token('a', 'z'));
+        letter.set_action([](Ctx&, Span, char c) -> long { return c - 'a'; });
+        g["factor"] = g["letter"] | (g.terminal('(') >> g["expr"] >> g.terminal(')'));
+        g["factor"].on_match([this](Ctx&, const Ctx::ParseTreeNodePtr&) { ++factors; });
+        auto sum = [](Ctx&, Span, long first, std::vector<std::tuple<char, long>> rest) -> long {
+            for (const auto& operand : rest) {
+                first += std::get<1>(operand);
+            }
+            return first;
+        };
+        auto term = (g["term"] = g["factor"] >> *((g.token('*') | g.token('/')) >> g["factor"]));
+        term.set_action(sum);
+        auto expr = (g["expr"] = g["term"] >> *((g.token('+') | g.token('-')) >> g["term"]));
+        expr.set_action(sum);
+        g.set_start("expr");
+    }
+};
+
+// A statement language whose keywords commit their alternative by cut:
+//   prog = stmt*
+//   stmt = "let" ~ " " name "=" num ";" / "print" ~ " " num ";"
+// A malformed statement after its keyword is a cut-committed failure, which
+// is what the invalid-input corpus exercises.
+struct StatementWorkload
+{
+    Grammar<> g;
+    StatementWorkload()
+    {
+        auto digit = g.terminal('0', '9');
+        g["num"] = +digit;
+        g["name"] = +g.terminal('a', 'z') >> *digit;
+        g["stmt"] =
+            (g.terminalSeq("let") >> g.cut() >> g.terminal(' ') >> g["name"] >> g.terminal('=') >>
+             g["num"] >> g.terminal(';')) |
+            (g.terminalSeq("print") >> g.cut() >> g.terminal(' ') >> g["num"] >> g.terminal(';'));
+        g["prog"] = *g["stmt"];
+        g.set_start("prog");
+    }
+};
+
+// `ok;` statements where every statement recovers: a failing statement
+// skips ahead to the next sync character. Over broken_lines() nearly all
+// the time goes into the recovery scan. The attempt at end of input also
+// recovers (to EOF), so a document of N lines yields N+1 diagnostics.
+struct RecoveryWorkload
+{
+    Grammar<> g;
+    explicit RecoveryWorkload(RecoverSpec<char> spec)
+    {
+        g["stmt"] = g.terminalSeq("ok") >> g.terminal(';');
+        g["stmt"].set_recovery(std::move(spec));
+        g["prog"] = *g["stmt"];
+        g.set_start("prog");
+    }
+};
+
+// The statement language without cuts, recovering each failed statement at
+// the next `;` — the editor/linter path over statements_with_errors(). As
+// with RecoveryWorkload, the attempt at end of input recovers too, so a
+// document with E broken statements yields E+1 diagnostics.
+struct RecoveringStatementWorkload
+{
+    Grammar<> g;
+    RecoveringStatementWorkload()
+    {
+        auto digit = g.terminal('0', '9');
+        g["num"] = +digit;
+        g["name"] = +g.terminal('a', 'z') >> *digit;
+        g["stmt"] = (g.terminalSeq("let ") >> g["name"] >> g.terminal('=') >> g["num"] >>
+                     g.terminal(';')) |
+                    (g.terminalSeq("print ") >> g["num"] >> g.terminal(';'));
+        g["stmt"].set_recovery(recover_set<char>({';'}));
+        g["prog"] = *g["stmt"];
+        g.set_start("prog");
+    }
+};
+
+// Ordered choice whose alternatives share an inline (unmemoized) prefix:
+//   e    = list "a" / list "b" / list "c" / "x"
+//   list = "(" e ("," e)* ")"
+// Over backtrack_lists() every list ends in "c", so each level's list is
+// scanned three times; the nested `e`s are memo hits on the second and third
+// scan, which is what keeps the parse linear.
+struct BacktrackWorkload
+{
+    Grammar<> g;
+    BacktrackWorkload()
+    {
+        auto list = g.terminal('(') >> g["e"] >> *(g.terminal(',') >> g["e"]) >> g.terminal(')');
+        g["e"] = (list >> g.terminal('a')) | (list >> g.terminal('b')) |
+                 (list >> g.terminal('c')) | g.terminal('x');
+        g.set_start("e");
+    }
+};
+
+// A statement that is first tried as an assignment target list, then as a
+// plain list whose separators commit by cut:
+//   stmt   = assign / list
+//   assign = name ("," name)* "="
+//   list   = name item*
+//   item   = "," ~ name / ";" ~ name
+// Over name_list() the assign attempt memoizes `name` at every element
+// before it fails at end of input, so each item's cut commits with the
+// rest of the list still in the memo.
+struct CutListWorkload
+{
+    Grammar<> g;
+    CutListWorkload()
+    {
+        g["name"] = +g.terminal('a', 'z');
+        g["assign"] = g["name"] >> *(g.terminal(',') >> g["name"]) >> g.terminal('=');
+        g["item"] = (g.terminal(',') >> g.cut() >> g["name"]) |
+                    (g.terminal(';') >> g.cut() >> g["name"]);
+        g["list"] = g["name"] >> *g["item"];
+        g["stmt"] = g["assign"] | g["list"];
+        g.set_start("stmt");
+    }
+};
+
 // Verbatim copy of the Lua 5.4 (subset) grammar from test/lua.cpp.
 struct LuaWorkload
 {
@@ -262,89 +440,619 @@ struct LuaWorkload
 } // namespace
 
 // -------------------------------------------------------------------------
-// main.
+// Workloads.
 // -------------------------------------------------------------------------
-int main(int argc, char** argv)
+
+// JSON: wide array (allocation + memo pressure).
+PEGLIB_BENCH_WORKLOAD(json_wide)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload w;
+    auto input = peglib_bench::fixtures::wide_json_array(n.json_wide_n);
+    run(bench, "json wide array", input, n.iters_small, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// JSON: wide array from a memory-mapped file (should track the in-memory
+// row: same fast path, no copy into a std::string).
+PEGLIB_BENCH_WORKLOAD(json_wide_mmap)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload w;
+    auto input = peglib_bench::fixtures::wide_json_array(n.json_wide_n);
+    BenchFile file{"peglib_bench_wide.json", input};
+    run_source(
+        bench,
+        "json wide array (mmap)",
+        input.size(),
+        n.iters_small,
+        [&] { return from_mmap<char>(file.path); },
+        [&](Ctx& ctx) { return w.g.parse(ctx) && ctx.ended(); });
+}
+
+// JSON: wide array from a paged FileSource (virtual at() per char).
+PEGLIB_BENCH_WORKLOAD(json_wide_file)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload w;
+    auto input = peglib_bench::fixtures::wide_json_array(n.json_wide_n);
+    BenchFile file{"peglib_bench_wide_paged.json", input};
+    run_source(
+        bench,
+        "json wide array (FileSource)",
+        input.size(),
+        n.iters_small,
+        [&] { return from_file<char>(file.path); },
+        [&](Ctx& ctx) { return w.g.parse(ctx) && ctx.ended(); });
+}
+
+// JSON: deep nesting (recursion + per-level node).
+PEGLIB_BENCH_WORKLOAD(json_deep)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload w;
+    auto input = peglib_bench::fixtures::deeply_nested_json(n.json_deep_n);
+    run(bench, "json deep nest", input, n.iters_small, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// Arithmetic (ordered-choice backtracking / failure churn).
+PEGLIB_BENCH_WORKLOAD(arith)
 {
-    bool quick = false;
-    for (int i = 1; i < argc; ++i) {
-        if (std::strcmp(argv[i], "--quick") == 0)
-            quick = true;
+    const Sizes n = sizes(bench);
+    ArithWorkload w;
+    auto input = peglib_bench::fixtures::dense_arithmetic(n.arith_n);
+    run(bench, "arith dense (backtrack)", input, n.iters_large, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// The same input through parse_ast with typed actions and an on_match
+// hook, followed by where the time of one parse went (ParsePhaseStats,
+// averaged over the row's iterations).
+PEGLIB_BENCH_WORKLOAD(arith_ast)
+{
+    const Sizes n = sizes(bench);
+    TypedArithWorkload w;
+    using TypedCtx = TypedArithWorkload::Ctx;
+    auto input = peglib_bench::fixtures::dense_arithmetic(n.arith_n);
+    bench.run_fn("arith dense parse_ast (typed)", input.size(), n.iters_large, [&] {
+        TypedCtx ctx{input};
+        return w.g.parse_ast("expr", ctx).has_value() && ctx.ended();
+    });
+    if (!bench.selected("arith dense parse_ast (typed)")) {
+        return;
+    }
+    ParsePhaseStats sum;
+    for (int i = 0; i < n.iters_large; ++i) {
+        TypedCtx ctx{input};
+        ParsePhaseStats stats;
+        (void)w.g.parse_ast("expr", ctx, stats);
+        for (auto [to, from] : {std::pair{&sum.skip, &stats.skip},
+                                std::pair{&sum.tree, &stats.tree},
+                                std::pair{&sum.on_match, &stats.on_match},
+                                std::pair{&sum.fold, &stats.fold}}) {
+            to->ns += from->ns;
+            to->nodes += from->nodes;
+        }
     }
+    const auto iters = static_cast<std::uint64_t>(n.iters_large);
+    const double total = static_cast<double>(sum.total_ns());
+    for (auto [name, phase] : {std::pair{"skip", &sum.skip},
+                               std::pair{"tree", &sum.tree},
+                               std::pair{"on_match", &sum.on_match},
+                               std::pair{"fold", &sum.fold}}) {
+        bench.note("  %-9s %12llu ns %5.1f%% %8zu nodes\n",
+                   name,
+                   static_cast<unsigned long long>(phase->ns / iters),
+                   total > 0 ? 100.0 * static_cast<double>(phase->ns) / total : 0.0,
+                   phase->nodes / static_cast<std::size_t>(iters));
+    }
+}
 
-    // Iteration counts. Sized so a default run stays around a few seconds:
-    // parse time per iteration dominates the steady_clock granularity, and the
-    // total batch keeps the process short. --quick divides by 10 for a smoke
-    // check that everything links and parses.
-    //
-    // json_deep_n is capped well below the recursion ceiling: peglib is a
-    // recursive-descent engine and deeply-nested input drives one C++ stack
-    // frame per nesting level (array → value → array → …), each level spanning
-    // several frames (NonTerminal::parseImpl → parse → Rule::parse →
-    // SequenceExpr::parse …). Depth ~2000 parses cleanly under the default 8MB
-    // stack; 4000 overflows it (SIGSEGV). 1500 keeps comfortable headroom while
-    // still producing enough node/allocation work to measure.
-    const int json_wide_n = quick ? 400 : 4000;
-    const int json_deep_n = quick ? 300 : 1500;
-    const int arith_n = quick ? 500 : 5000;
-    const int lr_n = quick ? 500 : 5000;
-    const int lua_n = quick ? 200 : 2000;
-
-    const int iters_small = quick ? 10 : 100; // for the larger-input workloads
-    const int iters_large = quick ? 30 : 300; // for the smaller-input workloads
-    const int warmup = 3;
-
-    print_header();
-
-    // --- JSON: wide array (allocation + memo pressure) ---
+// Arithmetic over PagedFileSource: page size x page count sweep
+// (backtracking re-reads pages behind the head; read-ahead overlaps the
+// forward scan with I/O).
+PEGLIB_BENCH_WORKLOAD(arith_paged)
+{
+    const Sizes n = sizes(bench);
+    ArithWorkload w;
+    auto input = peglib_bench::fixtures::dense_arithmetic(n.arith_n);
+    BenchFile file{"peglib_bench_arith.txt", input};
+    struct Geometry
     {
-        JsonWorkload w;
-        auto input = peglib_bench::fixtures::wide_json_array(json_wide_n);
-        auto r = run("json wide array", input, warmup, iters_small, [&](Ctx& ctx) {
-            return w.g.parse(ctx) && ctx.ended();
-        });
-        print_result(r);
+        const char* name;
+        PagedFileOptions options;
+    };
+    const Geometry sweep[] = {
+        {"arith paged P=256 N=2", {.page_size = 256, .page_count = 2}},
+        {"arith paged P=256 N=16", {.page_size = 256, .page_count = 16}},
+        {"arith paged P=4096 N=2", {.page_size = 4096, .page_count = 2}},
+        {"arith paged P=4096 N=8", {.page_size = 4096, .page_count = 8}},
+        {"arith paged P=4096 N=8 read-ahead",
+         {.page_size = 4096, .page_count = 8, .read_ahead = true}},
+    };
+    for (const auto& geo : sweep) {
+        run_source(
+            bench,
+            geo.name,
+            input.size(),
+            n.iters_large,
+            [&] { return from_paged_file<char>(file.path, geo.options); },
+            [&](Ctx& ctx) { return w.g.parse(ctx) && ctx.ended(); });
     }
+}
 
-    // --- JSON: deep nesting (recursion + per-level node) ---
-    {
-        JsonWorkload w;
-        auto input = peglib_bench::fixtures::deeply_nested_json(json_deep_n);
-        auto r = run("json deep nest", input, warmup, iters_small, [&](Ctx& ctx) {
-            return w.g.parse(ctx) && ctx.ended();
-        });
-        print_result(r);
+// Left-recursive (seed-grow loop + LR scan).
+PEGLIB_BENCH_WORKLOAD(expr_lr)
+{
+    const Sizes n = sizes(bench);
+    ExprLRWorkload w;
+    auto input = peglib_bench::fixtures::left_recursive_chain(n.lr_n);
+    run(bench, "expr left-recursive", input, n.iters_large, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// Lua-like chunk (real-world grammar breadth).
+PEGLIB_BENCH_WORKLOAD(lua)
+{
+    const Sizes n = sizes(bench);
+    LuaWorkload w;
+    auto input = peglib_bench::fixtures::lua_like_chunk(n.lua_n);
+    run(bench, "lua chunk", input, n.iters_small, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+    if (!bench.selected("lua chunk")) {
+        return;
     }
+    // What one parse leaves behind in its Context (Context::memory_stats).
+    Ctx ctx{input};
+    const MemoryStats m = ctx.memory_stats(w.g.parse_tree("chunk", ctx));
+    bench.note("  memory: arena %zu nodes (%zu in tree, %zu garbage) %zu bytes; "
+               "memo %zu entries at %zu positions, %zu blocks %zu bytes\n",
+               m.arena_nodes,
+               m.tree_nodes,
+               m.garbage_nodes,
+               m.arena_bytes,
+               m.memo_entries,
+               m.memo_positions,
+               m.memo_blocks,
+               m.memo_bytes);
+}
 
-    // --- Arithmetic (ordered-choice backtracking / failure churn) ---
-    {
-        ArithWorkload w;
-        auto input = peglib_bench::fixtures::dense_arithmetic(arith_n);
-        auto r = run("arith dense (backtrack)", input, warmup, iters_large, [&](Ctx& ctx) {
+// The lua chunk row under limits that never trigger: the production cost of
+// leaving every ParseLimits check on.
+PEGLIB_BENCH_WORKLOAD(limits)
+{
+    const Sizes n = sizes(bench);
+    LuaWorkload w;
+    auto input = peglib_bench::fixtures::lua_like_chunk(n.lua_n);
+    std::atomic<bool> cancel{false};
+    run(bench, "lua chunk (limits on)", input, n.iters_small, [&](Ctx& ctx) {
+        ctx.limits({.max_steps = std::uint64_t{1} << 40,
+                    .deadline = std::chrono::steady_clock::now() + std::chrono::hours{1},
+                    .max_memory = std::size_t{1} << 40,
+                    .max_depth = 100000,
+                    .cancel = &cancel});
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// The lua chunk row with a RuleProfiler attached: the cost of exact mode
+// (two clock reads per rule application) and of sampling mode, then the
+// hottest rules by self time from the exact run.
+PEGLIB_BENCH_WORKLOAD(profiler)
+{
+    const Sizes n = sizes(bench);
+    LuaWorkload w;
+    auto input = peglib_bench::fixtures::lua_like_chunk(n.lua_n);
+    RuleProfiler exact;
+    RuleProfiler sampled{std::chrono::microseconds{100}};
+    for (auto [name, prof] : {std::pair{"lua chunk (profiler exact)", &exact},
+                              std::pair{"lua chunk (profiler sampling 100us)", &sampled}}) {
+        run(bench, name, input, n.iters_small, [&, prof](Ctx& ctx) {
+            ctx.profiler(prof);
             return w.g.parse(ctx) && ctx.ended();
         });
-        print_result(r);
     }
+    if (!bench.selected("lua chunk (profiler exact)")) {
+        return;
+    }
+    exact.clear(); // one parse, so calls are per parse
+    Ctx ctx{input};
+    ctx.profiler(&exact);
+    (void)w.g.parse(ctx);
+    const auto rules = exact.rules();
+    std::uint64_t total = 0;
+    for (const auto& r : rules) {
+        total += r.self_ns;
+    }
+    for (std::size_t i = 0; i < rules.size() && i < 5; ++i) {
+        bench.note("  %-16s %5.1f%% self %10llu calls\n",
+                   rules[i].name.c_str(),
+                   total > 0 ? 100.0 * static_cast<double>(rules[i].self_ns) /
+                                   static_cast<double>(total)
+                             : 0.0,
+                   static_cast<unsigned long long>(rules[i].calls));
+    }
+}
 
-    // --- Left-recursive (seed-grow loop + LR scan) ---
-    {
-        ExprLRWorkload w;
-        auto input = peglib_bench::fixtures::left_recursive_chain(lr_n);
-        auto r = run("expr left-recursive", input, warmup, iters_large, [&](Ctx& ctx) {
-            return w.g.parse(ctx) && ctx.ended();
-        });
-        print_result(r);
+// Realistic documents: twitter-like JSON (strings, escapes, mixed types,
+// pretty-printed), canada-like JSON (number-dense), and a Lua statement mix
+// with nested blocks — the shapes the synthetic rows above leave out.
+PEGLIB_BENCH_WORKLOAD(realistic)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload json;
+    LuaWorkload lua;
+    const auto twitter = peglib_bench::fixtures::realistic_json(bench.quick() ? 10 : 100);
+    const auto canada = peglib_bench::fixtures::geojson_polygons(bench.quick() ? 5 : 50);
+    const auto chunk = peglib_bench::fixtures::realistic_lua(bench.quick() ? 10 : 100);
+    auto parses = [](const Grammar<>& g) {
+        return [&g](Ctx& ctx) { return g.parse(ctx) && ctx.ended(); };
+    };
+    run(bench, "json realistic (twitter-like)", twitter, n.iters_small, parses(json.g));
+    run(bench, "json numbers (canada-like)", canada, n.iters_small, parses(json.g));
+    run(bench, "lua realistic", chunk, n.iters_small, parses(lua.g));
+}
+
+// ErrorTracking::Deferred on valid inputs: no expected-set bookkeeping at
+// all (compare with the tracked rows above).
+PEGLIB_BENCH_WORKLOAD(tracking_deferred)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload json;
+    ArithWorkload arith;
+    LuaWorkload lua;
+    auto json_input = peglib_bench::fixtures::wide_json_array(n.json_wide_n);
+    auto arith_input = peglib_bench::fixtures::dense_arithmetic(n.arith_n);
+    auto lua_input = peglib_bench::fixtures::lua_like_chunk(n.lua_n);
+    auto deferred = [](const auto& g) {
+        return [&g](Ctx& ctx) {
+            ctx.error_tracking(ErrorTracking::Deferred);
+            return g.parse(ctx) && ctx.ended();
+        };
+    };
+    run(bench, "json wide array (tracking deferred)", json_input, n.iters_small, deferred(json.g));
+    run(bench, "arith dense (tracking deferred)", arith_input, n.iters_large, deferred(arith.g));
+    run(bench, "lua chunk (tracking deferred)", lua_input, n.iters_small, deferred(lua.g));
+}
+
+// Invalid-input corpus: every document ends in a cut-committed failure (a
+// linter over bad files; one fresh Context per file).
+PEGLIB_BENCH_WORKLOAD(cut_failure)
+{
+    const Sizes n = sizes(bench);
+    StatementWorkload w;
+    const auto docs = peglib_bench::fixtures::invalid_statement_corpus(bench.quick() ? 100 : 1000);
+    std::size_t bytes = 0;
+    for (const auto& d : docs) {
+        bytes += d.size();
     }
+    bench.run_fn("cut-failure corpus", bytes, n.iters_small, [&] {
+        bool ok = true;
+        for (const auto& d : docs) {
+            Ctx ctx{d};
+            ok = !w.g.parse(ctx) && ctx.take_error().has_value() && ok;
+        }
+        return ok;
+    });
+}
 
-    // --- Lua-like chunk (real-world grammar breadth) ---
-    {
-        LuaWorkload w;
-        auto input = peglib_bench::fixtures::lua_like_chunk(lua_n);
-        auto r = run("lua chunk", input, warmup, iters_small, [&](Ctx& ctx) {
-            return w.g.parse(ctx) && ctx.ended();
-        });
-        print_result(r);
+// Cut commits over a memo filled by a failed lookahead alternative.
+PEGLIB_BENCH_WORKLOAD(cut_list)
+{
+    const Sizes n = sizes(bench);
+    CutListWorkload w;
+    auto input = peglib_bench::fixtures::name_list(bench.quick() ? 500 : 4000);
+    run(bench, "cut list after failed lookahead", input, n.iters_small, [&](Ctx& ctx) {
+        return w.g.parse(ctx) && ctx.ended();
+    });
+}
+
+// Error recovery over broken input: the sync-token scan, by spec kind, plus
+// the set scan over a paged source.
+PEGLIB_BENCH_WORKLOAD(recovery)
+{
+    const Sizes n = sizes(bench);
+    const std::size_t lines = bench.quick() ? 200 : 2000;
+    const auto semi = peglib_bench::fixtures::broken_lines(lines, 200, ';');
+    const auto eol = peglib_bench::fixtures::broken_lines(lines, 200, '\n');
+    RecoveryWorkload set_w{recover_set<char>({';', '}'})};
+    RecoveryWorkload eol_w{recover_eol<char>()};
+    RecoveryWorkload pred_w{recover_predicate<char>([](char c) { return c == ';' || c == '}'; })};
+    auto recovered = [lines](const Grammar<>& g) {
+        return [&g, lines](Ctx& ctx) {
+            return g.parse(ctx) && ctx.ended() && ctx.take_diagnostics().size() == lines + 1;
+        };
+    };
+    run(bench,
+        "recovery scan (set)",
+        semi,
+        n.iters_small,
+        recovered(set_w.g),
+        Allocates::Diagnostics);
+    run(bench,
+        "recovery scan (eol)",
+        eol,
+        n.iters_small,
+        recovered(eol_w.g),
+        Allocates::Diagnostics);
+    run(bench,
+        "recovery scan (predicate)",
+        semi,
+        n.iters_small,
+        recovered(pred_w.g),
+        Allocates::Diagnostics);
+    BenchFile file{"peglib_bench_recovery.txt", semi};
+    run_source(
+        bench,
+        "recovery scan (set, paged)",
+        semi.size(),
+        n.iters_small,
+        [&] { return from_paged_file<char>(file.path, {.page_size = 4096, .page_count = 4}); },
+        recovered(set_w.g));
+}
+
+// Error-laden input at a controlled rate: statement-level recovery (one
+// diagnostic per broken statement, plus the end-of-input attempt), and a
+// corpus where a share of the documents ends in a cut-committed failure.
+PEGLIB_BENCH_WORKLOAD(error_rate)
+{
+    const Sizes n = sizes(bench);
+    const std::size_t statements = bench.quick() ? 500 : 5000;
+    RecoveringStatementWorkload recovering;
+    for (const std::size_t pct : {1, 10, 50}) {
+        const auto input = peglib_bench::fixtures::statements_with_errors(statements, pct);
+        const std::string name = "statements " + std::to_string(pct) + "% errors (recovery)";
+        run(
+            bench,
+            name.c_str(),
+            input.text,
+            n.iters_small,
+            [&](Ctx& ctx) {
+                return recovering.g.parse(ctx) && ctx.ended() &&
+                       ctx.take_diagnostics().size() == input.errors + 1;
+            },
+            Allocates::Diagnostics);
+    }
+
+    StatementWorkload stmt;
+    std::size_t invalid = 0;
+    const auto docs =
+        peglib_bench::fixtures::statement_documents(bench.quick() ? 100 : 1000, 10, invalid);
+    std::size_t bytes = 0;
+    for (const auto& d : docs) {
+        bytes += d.size();
+    }
+    bench.run_fn("statement corpus 10% invalid", bytes, n.iters_small, [&] {
+        std::size_t failed = 0;
+        for (const auto& d : docs) {
+            Ctx ctx{d};
+            failed += stmt.g.parse(ctx) && ctx.ended() ? 0 : 1;
+        }
+        return failed == invalid;
+    });
+}
+
+// Adversarial backtracking: alternatives re-scanning a shared prefix, and
+// unclosed nesting that fails only at end of input (the diagnostic must
+// point there).
+PEGLIB_BENCH_WORKLOAD(adversarial)
+{
+    const Sizes n = sizes(bench);
+    BacktrackWorkload backtrack;
+    const auto lists = peglib_bench::fixtures::backtrack_lists(bench.quick() ? 5 : 7);
+    run(bench, "backtrack shared prefix", lists, n.iters_small, [&](Ctx& ctx) {
+        return backtrack.g.parse(ctx) && ctx.ended();
+    });
+
+    ArithWorkload arith;
+    const auto unclosed = peglib_bench::fixtures::unclosed_arithmetic(bench.quick() ? 100 : 400);
+    run(
+        bench,
+        "arith unclosed nesting (failure)",
+        unclosed,
+        n.iters_small,
+        [&](Ctx& ctx) {
+            if (arith.g.parse(ctx) && ctx.ended()) {
+                return false;
+            }
+            const auto error = ctx.take_error();
+            return error.has_value() && error->position() == unclosed.size();
+        },
+        Allocates::Diagnostics);
+}
+
+// Grammar-directed inputs (peg::generate): documents drawn from the bench
+// grammars themselves rather than a hand-written fixture, so every
+// alternative the grammar has — not just the ones a fixture author thought
+// of — shows up in the timed input. The near-miss row parses inputs one
+// mutation away from valid, which must fail.
+PEGLIB_BENCH_WORKLOAD(generated)
+{
+    const Sizes n = sizes(bench);
+    JsonWorkload json;
+    ArithWorkload arith;
+    GenerateOptions options;
+    options.seed = 42;
+    options.target_size = bench.quick() ? 2048 : 16384;
+    const auto json_doc = generate(json.g, "json", options).value_or("");
+    const auto arith_doc = generate(arith.g, "expr", options).value_or("");
+    options.target_size = 256;
+    std::vector<std::string> near_misses;
+    for (std::uint64_t seed = 1; seed <= 100; ++seed) {
+        options.seed = seed;
+        if (auto doc = generate_invalid(json.g, "json", options)) {
+            near_misses.push_back(std::move(*doc));
+        }
+    }
+    std::size_t near_miss_bytes = 0;
+    for (const auto& d : near_misses) {
+        near_miss_bytes += d.size();
     }
 
-    return 0;
+    auto parses = [](const Grammar<>& g) {
+        return [&g](Ctx& ctx) { return g.parse(ctx) && ctx.ended(); };
+    };
+    run(bench, "json generated", json_doc, n.iters_small, parses(json.g));
+    run(bench, "arith generated", arith_doc, n.iters_small, parses(arith.g));
+    bench.run_fn("json generated near-miss x100", near_miss_bytes, n.iters_small, [&] {
+        bool ok = near_misses.size() == 100;
+        for (const auto& d : near_misses) {
+            Ctx ctx{d};
+            ok = !(json.g.parse(ctx) && ctx.ended()) && ok;
+        }
+        return ok;
+    });
+}
+
+// SourceMap construction (line-index prescan), serial vs parallel, and over
+// a paged FileSource (one chunk per page).
+PEGLIB_BENCH_WORKLOAD(sourcemap)
+{
+    const Sizes n = sizes(bench);
+    const std::size_t lines = bench.quick() ? 10000 : 100000;
+    auto input = peglib_bench::fixtures::source_lines(lines - 1);
+    bench.run_fn("sourcemap build (serial)", input.size(), n.iters_small, [&] {
+        return SourceMap{std::string_view{input}}.num_lines() == lines;
+    });
+    bench.run_fn("sourcemap build (parallel)", input.size(), n.iters_small, [&] {
+        return SourceMap{std::string_view{input}, SourceMapOptions{.parallel_threshold = 1}}
+                   .num_lines() == lines;
+    });
+    BenchFile file{"peglib_bench_sourcemap.txt", input};
+    FileSource<char, 4096> fs{file.path};
+    bench.run_fn("sourcemap build (FileSource)", input.size(), n.iters_small, [&] {
+        return SourceMap{fs}.num_lines() == lines;
+    });
+
+    // Compact line index: build cost, lookup latency and memory against the
+    // one-size_t-per-line vector. Lookups are spread over the input (a fixed
+    // stride coprime with the size) so both probe every block.
+    const SourceMapOptions compact_opts{.index = LineIndex::Compact};
+    bench.run_fn("sourcemap build (compact)", input.size(), n.iters_small, [&] {
+        return SourceMap{std::string_view{input}, compact_opts}.num_lines() == lines;
+    });
+
+    const SourceMap vec_map{std::string_view{input}};
+    const SourceMap compact_map{std::string_view{input}, compact_opts};
+    constexpr std::size_t lookups = 10000;
+    auto probe = [&](const SourceMap& map) {
+        std::size_t sum = 0;
+        for (std::size_t i = 0; i < lookups; ++i) {
+            sum += map.locate((i * 7919) % input.size()).line;
+        }
+        return sum;
+    };
+    const std::size_t expect = probe(vec_map);
+    bench.run_fn("sourcemap locate x10k (vector)", input.size(), n.iters_small, [&] {
+        return probe(vec_map) == expect;
+    });
+    bench.run_fn("sourcemap locate x10k (compact)", input.size(), n.iters_small, [&] {
+        return probe(compact_map) == expect;
+    });
+    if (bench.selected("sourcemap locate")) {
+        bench.note("  line index bytes for %zu lines: vector %zu, compact %zu\n",
+                   lines,
+                   vec_map.index_memory_bytes(),
+                   compact_map.index_memory_bytes());
+    }
+}
+
+// -------------------------------------------------------------------------
+// Scaling (--scaling): every fixture generator at doubling sizes. Base sizes
+// keep the smallest parse well above the clock granularity and the largest
+// (32x, or 8x with --quick) around a tenth of a second; json deep nest
+// stays under the recursion ceiling.
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_SCALING(fixtures)
+{
+    using peglib_bench::fixtures::broken_lines;
+    JsonWorkload json;
+    ArithWorkload arith;
+    ExprLRWorkload lr;
+    LuaWorkload lua;
+    StatementWorkload stmt;
+    CutListWorkload cut_list;
+    RecoveryWorkload recovery{recover_set<char>({';', '}'})};
+    RecoveringStatementWorkload recovering;
+    auto parses = [](const Grammar<>& g) {
+        return [&g](const std::string& input) {
+            Ctx ctx{input};
+            return g.parse(ctx) && ctx.ended();
+        };
+    };
+
+    bench.scale("json wide array", 250, peglib_bench::fixtures::wide_json_array, parses(json.g));
+    bench.scale("json deep nest", 40, peglib_bench::fixtures::deeply_nested_json, parses(json.g));
+    bench.scale(
+        "arith dense (backtrack)", 500, peglib_bench::fixtures::dense_arithmetic, parses(arith.g));
+    bench.scale(
+        "expr left-recursive", 500, peglib_bench::fixtures::left_recursive_chain, parses(lr.g));
+    bench.scale(
+        "lua chunk",
+        50,
+        [](std::size_t n) { return peglib_bench::fixtures::lua_like_chunk(n); },
+        parses(lua.g));
+    bench.scale(
+        "json realistic (twitter-like)",
+        5,
+        [](std::size_t n) { return peglib_bench::fixtures::realistic_json(n); },
+        parses(json.g));
+    bench.scale(
+        "json numbers (canada-like)",
+        2,
+        [](std::size_t n) { return peglib_bench::fixtures::geojson_polygons(n); },
+        parses(json.g));
+    bench.scale(
+        "lua realistic",
+        5,
+        [](std::size_t n) { return peglib_bench::fixtures::realistic_lua(n); },
+        parses(lua.g));
+    bench.scale("cut list after failed lookahead",
+                250,
+                peglib_bench::fixtures::name_list,
+                parses(cut_list.g));
+    bench.scale("cut-failure corpus",
+                50,
+                peglib_bench::fixtures::invalid_statement_corpus,
+                [&](const std::vector<std::string>& docs) {
+                    bool ok = true;
+                    for (const auto& d : docs) {
+                        Ctx ctx{d};
+                        ok = !stmt.g.parse(ctx) && ok;
+                    }
+                    return ok;
+                });
+    bench.scale(
+        "recovery scan (set)",
+        100,
+        [](std::size_t n) { return broken_lines(n, 200, ';'); },
+        [&](const std::string& input) {
+            Ctx ctx{input};
+            return recovery.g.parse(ctx) && ctx.ended();
+        });
+    bench.scale(
+        "statements 10% errors (recovery)",
+        250,
+        [](std::size_t n) { return peglib_bench::fixtures::statements_with_errors(n, 10).text; },
+        [&](const std::string& input) {
+            Ctx ctx{input};
+            return recovering.g.parse(ctx) && ctx.ended();
+        });
+    bench.scale("sourcemap build (serial)",
+                2000,
+                peglib_bench::fixtures::source_lines,
+                [](const std::string& input) {
+                    return SourceMap{std::string_view{input}}.num_lines() > 0;
+                });
+}
+
+int main(int argc, char** argv)
+{
+    return peglib_bench::run_main(argc, argv);
 }
@@ -18,16 +18,75 @@
 //   - lua_like_chunk     : a synthetic Lua-like source exercising the
 //                          lua_grammar (statements, expressions, function
 //                          defs). Scales with statement count N.
+//   - source_lines       : plain text of N lines of varying width (some
+//                          CRLF) for line-index (SourceMap) workloads.
+//   - invalid_statement_corpus : N small documents for the statement
+//                          grammar, each failing after a committed (cut)
+//                          keyword — the linter-over-bad-files case.
+//   - broken_lines       : N lines of unparseable filler, each closed by a
+//                          sync character — error-recovery scan workloads.
+//   - name_list          : N comma-separated names — a statement that first
+//                          tries the whole list as an assignment target,
+//                          then commits (cut) element by element.
+//
+// Realistic, error-laden and adversarial inputs (seeded, deterministic on
+// every platform — Rng below, not <random>'s distributions):
+//   - realistic_json     : twitter-like records — mixed types, optional
+//                          fields, nested objects/arrays, strings with
+//                          escapes and raw UTF-8, pretty-printed.
+//   - geojson_polygons   : canada-like — number-dense coordinate rings with
+//                          long fractions and some exponents.
+//   - realistic_lua      : a statement mix (assignments, calls, locals,
+//                          if/loops/function bodies nesting 3 deep, tables)
+//                          within the degenerate bench Lua grammar.
+//   - statements_with_errors : the `let`/`print` language with a chosen
+//                          share of broken statements (each keeps its `;`,
+//                          so recovery resyncs one statement at a time).
+//   - statement_documents : N documents, a chosen share of them broken
+//                          after a committed keyword.
+//   - backtrack_lists    : nested lists whose alternatives share an inline
+//                          prefix and differ only after it — each level is
+//                          re-scanned by every failed alternative.
+//   - unclosed_arithmetic : deep parenthesized arithmetic missing its
+//                          closers, so the parse fails at end of input.
 // ---------------------------------------------------------------------------
 #ifndef PEGLIB_PERF_FIXTURES_HPP
 #define PEGLIB_PERF_FIXTURES_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace peglib_bench::fixtures
 {
 
+// splitmix64: small, seedable, and the same sequence on every platform.
+struct Rng
+{
+    std::uint64_t state;
+
+    explicit Rng(std::uint64_t seed) : state{seed} {}
+
+    std::uint64_t next()
+    {
+        std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [0, n); n > 0.
+    std::size_t below(std::size_t n) { return static_cast<std::size_t>(next() % n); }
+    // True with probability pct / 100.
+    bool percent(std::size_t pct) { return below(100) < pct; }
+    template<std::size_t N>
+    const char* pick(const char* const (&items)[N])
+    {
+        return items[below(N)];
+    }
+};
+
 // `{"k":0}` repeated N times, wrapped once: scales allocation + memo work
 // without exploding nesting depth. Approx 9*N bytes.
 inline std::string wide_json_array(std::size_t n)
@@ -113,6 +172,437 @@ inline std::string lua_like_chunk(std::size_t n_statements, std::size_t terms_pe
     return s;
 }
 
+// N lines of 0..79 filler characters, every seventh ending in CRLF. Average
+// line ~40 bytes — typical source-code density.
+inline std::string source_lines(std::size_t n_lines)
+{
+    std::string s;
+    s.reserve(42 * n_lines);
+    for (std::size_t i = 0; i < n_lines; ++i) {
+        s.append((i * 37) % 80, 'x');
+        s += (i % 7 == 0) ? "\r\n" : "\n";
+    }
+    return s;
+}
+
+// N documents of `let <name>=<num>;` / `print <num>;` statements, each
+// broken after a keyword has committed its alternative: a missing value, a
+// missing `;`, or a bad token. Valid statements before the error vary from 0
+// to 7, so the failure position moves through the document. ~40-130 bytes
+// each.
+inline std::vector<std::string> invalid_statement_corpus(std::size_t n_docs)
+{
+    static const char* const breaks[] = {"let q=;", "print ;", "let r=12", "print 7 x;"};
+    std::vector<std::string> docs;
+    docs.reserve(n_docs);
+    for (std::size_t d = 0; d < n_docs; ++d) {
+        std::string s;
+        for (std::size_t i = 0; i < d % 8; ++i) {
+            s += (i % 2 == 0) ? "let v" + std::to_string(i) + "=" + std::to_string(d) + ";"
+                              : "print " + std::to_string(i * d) + ";";
+        }
+        s += breaks[d % 4];
+        docs.push_back(std::move(s));
+    }
+    return docs;
+}
+
+// N lines of `width` filler characters that no statement rule accepts,
+// each closed by `sync` (e.g. ';' or '\n'). The filler never contains ';',
+// '}' or '\n', so a recovering rule scans the whole line before it resyncs.
+// Approx (width+1)*N bytes.
+inline std::string broken_lines(std::size_t n_lines, std::size_t width, char sync)
+{
+    static constexpr std::string_view filler = "x = (y + 42) * f(z, \"str\") - w[3] ";
+    std::string s;
+    s.reserve((width + 1) * n_lines);
+    for (std::size_t i = 0; i < n_lines; ++i) {
+        for (std::size_t j = 0; j < width; ++j) {
+            s += filler[(i + j) % filler.size()];
+        }
+        s += sync;
+    }
+    return s;
+}
+
+// `ab,cdef,g,...` — N names of 1..8 letters, comma-separated, with no
+// terminator. Approx 5.5*N bytes.
+inline std::string name_list(std::size_t n)
+{
+    std::string s;
+    s.reserve(6 * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i != 0)
+            s += ',';
+        for (std::size_t j = 0; j <= (i * 5) % 8; ++j) {
+            s += static_cast<char>('a' + (i + j) % 26);
+        }
+    }
+    return s;
+}
+
+// -------------------------------------------------------------------------
+// Realistic JSON.
+// -------------------------------------------------------------------------
+
+// A tweet-like text: words, hashtags and mentions, with JSON escapes (\",
+// \\, \n, \/, \uXXXX) and raw multi-byte UTF-8 mixed in.
+inline std::string json_text(Rng& rng, std::size_t words)
+{
+    static const char* const vocab[] = {
+        "the",        "parser",         "memo",       "caf\\u00e9",         "na\\u00efve",
+        "C:\\\\path", "\\\"quoted\\\"", "line\\nbrk", "http:\\/\\/t.co\\/x", "\\u263a",
+        "#peg",       "@peglib",        "packrat",    "\\u00fcber",         "日本語",
+        "emoji 🎉",   "résumé",         "O(n)",       "a+b*c",              "{braces}",
+        "[list]",     "tab\\there",     "100%"};
+    std::string s;
+    for (std::size_t i = 0; i < words; ++i) {
+        if (i != 0)
+            s += ' ';
+        s += rng.pick(vocab);
+    }
+    return s;
+}
+
+// A JSON number: integer, negative, fraction, or exponent form.
+inline std::string json_number(Rng& rng)
+{
+    switch (rng.below(5)) {
+    case 0:
+        return std::to_string(rng.below(100));
+    case 1:
+        return std::to_string(rng.next() >> 12); // large id-like integer
+    case 2:
+        return "-" + std::to_string(rng.below(100000));
+    case 3:
+        return std::to_string(rng.below(1000)) + "." + std::to_string(rng.below(1000000));
+    default:
+        return std::to_string(1 + rng.below(9)) + "." + std::to_string(rng.below(1000)) + "e" +
+               (rng.percent(50) ? "-" : "+") + std::to_string(rng.below(30));
+    }
+}
+
+// `{"statuses": [...], "search_metadata": {...}}` with N twitter-like
+// records, pretty-printed (2-space indent, newlines). Every record mixes
+// strings, numbers, booleans and null, nests `user` and `entities` objects,
+// and includes or omits optional fields at random. ~1.1 KB per record.
+inline std::string realistic_json(std::size_t n_records, std::uint64_t seed = 1)
+{
+    Rng rng{seed};
+    static const char* const langs[] = {"en", "ja", "fr", "de", "und"};
+    std::string s = "{\n  \"statuses\": [";
+    for (std::size_t i = 0; i < n_records; ++i) {
+        const std::string id = std::to_string(rng.next() >> 8);
+        s += i == 0 ? "\n" : ",\n";
+        s += "    {\n";
+        s += "      \"id\": " + id + ",\n";
+        s += "      \"id_str\": \"" + id + "\",\n";
+        s += "      \"created_at\": \"Mon Sep 24 03:35:21 +0000 2012\",\n";
+        s += "      \"text\": \"" + json_text(rng, 4 + rng.below(16)) + "\",\n";
+        s += "      \"truncated\": " + std::string{rng.percent(10) ? "true" : "false"} + ",\n";
+        s += "      \"lang\": \"" + std::string{rng.pick(langs)} + "\",\n";
+        s += "      \"user\": {\n";
+        s += "        \"id\": " + std::to_string(rng.below(1000000000)) + ",\n";
+        s += "        \"name\": \"" + json_text(rng, 1 + rng.below(3)) + "\",\n";
+        s += "        \"screen_name\": \"user_" + std::to_string(rng.below(100000)) + "\",\n";
+        s += "        \"location\": ";
+        s += rng.percent(40) ? "null" : "\"" + json_text(rng, 2) + "\"";
+        s += ",\n";
+        s += "        \"followers_count\": " + std::to_string(rng.below(50000)) + ",\n";
+        s += "        \"verified\": " + std::string{rng.percent(5) ? "true" : "false"} + "\n";
+        s += "      },\n";
+        s += "      \"entities\": {\n        \"hashtags\": [";
+        const std::size_t tags = rng.below(4);
+        for (std::size_t t = 0; t < tags; ++t) {
+            const std::size_t at = rng.below(120);
+            s += t == 0 ? "" : ", ";
+            s += "{\"text\": \"tag" + std::to_string(rng.below(1000)) + "\", \"indices\": [" +
+                 std::to_string(at) + ", " + std::to_string(at + 4 + rng.below(10)) + "]}";
+        }
+        s += "],\n        \"urls\": []\n      },\n";
+        if (rng.percent(30)) {
+            s += "      \"coordinates\": [" + json_number(rng) + ", " + json_number(rng) + "],\n";
+        }
+        if (rng.percent(20)) {
+            s += "      \"metrics\": {\"score\": " + json_number(rng) +
+                 ", \"weights\": [" + json_number(rng) + ", " + json_number(rng) + ", " +
+                 json_number(rng) + "]},\n";
+        }
+        s += "      \"retweet_count\": " + std::to_string(rng.below(5000)) + ",\n";
+        s += "      \"favorited\": false,\n";
+        s += "      \"in_reply_to\": null\n";
+        s += "    }";
+    }
+    s += "\n  ],\n  \"search_metadata\": {\"count\": " + std::to_string(n_records) +
+         ", \"completed_in\": 0.087, \"query\": \"%23peg\"}\n}\n";
+    return s;
+}
+
+// A GeoJSON FeatureCollection of N polygon rings, each of 8..63 points with
+// canada.json-style coordinates (`-65.613616999999977`): number parsing
+// dominates. ~40 bytes per point.
+inline std::string geojson_polygons(std::size_t n_rings, std::uint64_t seed = 1)
+{
+    Rng rng{seed};
+    auto coord = [&rng](int whole) {
+        std::string frac = std::to_string(rng.next() % 1000000000000000ULL);
+        frac.insert(0, 15 - std::min<std::size_t>(15, frac.size()), '0');
+        std::string v = std::to_string(whole) + "." + frac;
+        if (rng.percent(3)) {
+            v += "e-" + std::to_string(1 + rng.below(3));
+        }
+        return v;
+    };
+    std::string s = "{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\","
+                    "\"properties\":{\"name\":\"Canada\"},\"geometry\":{\"type\":\"Polygon\","
+                    "\"coordinates\":[";
+    for (std::size_t r = 0; r < n_rings; ++r) {
+        s += r == 0 ? "[" : ",[";
+        const std::size_t points = 8 + rng.below(56);
+        for (std::size_t p = 0; p < points; ++p) {
+            s += p == 0 ? "[" : ",[";
+            s += coord(-(40 + static_cast<int>(rng.below(100))));
+            s += ',';
+            s += coord(40 + static_cast<int>(rng.below(40)));
+            s += ']';
+        }
+        s += ']';
+    }
+    s += "]}}]}";
+    return s;
+}
+
+// -------------------------------------------------------------------------
+// Realistic Lua (for the bench Lua grammar: Name = 'a', Numeral = "10",
+// LiteralString = "\"hello\"", no whitespace).
+// -------------------------------------------------------------------------
+namespace detail
+{
+// The bench grammar's `expr` is an ordered choice tried before its
+// left-recursive `expr binop expr` branch, so a binary chain must open with a
+// term that only that branch can extend (a numeral, string or unary); a bare
+// name, nil/true/false, a table or a call would end the expression there.
+// Calls are therefore statement-only.
+inline void lua_expr(Rng& rng, std::string& s, std::size_t depth)
+{
+    static const char* const lead[] = {"10", "\"hello\"", "#a", "-10", "not10"};
+    static const char* const atoms[] = {
+        "10", "a", "\"hello\"", "nil", "true", "false", "#a", "-10", "not10"};
+    const std::size_t terms = 1 + rng.below(4);
+    if (terms == 1 && rng.percent(50)) {
+        s += rng.pick(atoms);
+        return;
+    }
+    for (std::size_t t = 0; t < terms; ++t) {
+        if (t != 0)
+            s += rng.percent(80) ? "+" : "//";
+        if (depth != 0 && (t != 0 || terms == 1) && rng.percent(10)) {
+            s += "{a=";
+            lua_expr(rng, s, depth - 1);
+            s += ",[10]=\"hello\",";
+            lua_expr(rng, s, depth - 1);
+            s += '}';
+        } else {
+            s += t == 0 ? rng.pick(lead) : rng.pick(atoms);
+        }
+    }
+}
+
+inline void lua_block(Rng& rng, std::string& s, std::size_t n, std::size_t depth);
+
+inline void lua_statement(Rng& rng, std::string& s, std::size_t depth)
+{
+    // Rough statement mix of real Lua code: mostly assignments and calls,
+    // then locals and control flow; compound statements only while nesting
+    // allows.
+    std::size_t roll = rng.below(100);
+    if (depth == 0 && roll >= 60) {
+        roll = rng.below(60);
+    }
+    if (roll < 30) {
+        s += rng.percent(20) ? "a,a=" : "a=";
+        lua_expr(rng, s, 2);
+        s += ';';
+    } else if (roll < 48) {
+        s += rng.percent(30) ? "a:a(" : "a(";
+        lua_expr(rng, s, 1);
+        s += ",\"hello\");";
+    } else if (roll < 60) {
+        s += "locala-";
+        lua_expr(rng, s, 1);
+        s += ';';
+    } else if (roll < 72) {
+        s += "if";
+        lua_expr(rng, s, 1);
+        s += "then";
+        lua_block(rng, s, 1 + rng.below(3), depth - 1);
+        if (rng.percent(40)) {
+            s += "elseif10then";
+            lua_block(rng, s, 1 + rng.below(2), depth - 1);
+        }
+        if (rng.percent(50)) {
+            // Without whitespace, `else` + an `if` statement reads as `elseif`:
+            // open the else block with an assignment.
+            s += "elsea=";
+            lua_expr(rng, s, 1);
+            s += ';';
+            lua_block(rng, s, rng.below(2), depth - 1);
+        }
+        s += "end";
+    } else if (roll < 78) {
+        s += "fora=10,";
+        lua_expr(rng, s, 0);
+        s += "do";
+        lua_block(rng, s, 1 + rng.below(3), depth - 1);
+        s += "end";
+    } else if (roll < 83) {
+        s += "while";
+        lua_expr(rng, s, 0);
+        s += rng.percent(30) ? "dobreak" : "do";
+        lua_block(rng, s, 1 + rng.below(3), depth - 1);
+        s += "end";
+    } else if (roll < 86) {
+        s += "repeat";
+        lua_block(rng, s, 1 + rng.below(2), depth - 1);
+        s += "until10";
+    } else if (roll < 95) {
+        s += rng.percent(30) ? "localfunctiona(" : "functiona.a:a(";
+        s += rng.percent(50) ? "a,a" : "a,...";
+        s += ')';
+        lua_block(rng, s, 1 + rng.below(4), depth - 1);
+        s += "end";
+    } else {
+        s += "doa=";
+        lua_expr(rng, s, 1);
+        s += ";end";
+    }
+}
+
+inline void lua_block(Rng& rng, std::string& s, std::size_t n, std::size_t depth)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        lua_statement(rng, s, depth);
+    }
+    if (rng.percent(25)) {
+        s += "return";
+        lua_expr(rng, s, 1);
+        s += ';';
+    }
+}
+} // namespace detail
+
+// N top-level statements (compound ones nest up to 3 deep), ~90 bytes each
+// on average.
+inline std::string realistic_lua(std::size_t n_statements, std::uint64_t seed = 1)
+{
+    Rng rng{seed};
+    std::string s;
+    for (std::size_t i = 0; i < n_statements; ++i) {
+        detail::lua_statement(rng, s, 3);
+    }
+    return s;
+}
+
+// -------------------------------------------------------------------------
+// Inputs with a controlled error rate.
+// -------------------------------------------------------------------------
+
+struct ErrorLadenInput
+{
+    std::string text;
+    std::size_t errors = 0; // broken statements in `text`
+};
+
+// N `let <name>=<num>;` / `print <num>;` statements (no whitespace between
+// them), `error_pct` percent of them broken: a missing value, a stray
+// token, or a missing keyword argument. Every statement, broken or not,
+// ends in `;`. ~10 bytes per statement.
+inline ErrorLadenInput statements_with_errors(std::size_t n_statements,
+                                              std::size_t error_pct,
+                                              std::uint64_t seed = 1)
+{
+    static const char* const broken[] = {
+        "let q=;", "print ?;", "let =3;", "print 7 x;", "lat r=1;"};
+    Rng rng{seed};
+    ErrorLadenInput out;
+    for (std::size_t i = 0; i < n_statements; ++i) {
+        if (rng.percent(error_pct)) {
+            out.text += rng.pick(broken);
+            ++out.errors;
+        } else if (rng.percent(50)) {
+            out.text +=
+                "let v" + std::to_string(i % 100) + "=" + std::to_string(rng.below(1000)) + ";";
+        } else {
+            out.text += "print " + std::to_string(rng.below(100000)) + ";";
+        }
+    }
+    return out;
+}
+
+// N documents of 1..8 statements each; `error_pct` percent of the documents
+// end in a statement broken after its keyword (a cut-committed failure),
+// the rest are valid. Returns the documents; `invalid` receives the count.
+inline std::vector<std::string> statement_documents(std::size_t n_docs,
+                                                    std::size_t error_pct,
+                                                    std::size_t& invalid,
+                                                    std::uint64_t seed = 1)
+{
+    static const char* const breaks[] = {"let q=;", "print ;", "let r=12", "print 7 x;"};
+    Rng rng{seed};
+    std::vector<std::string> docs;
+    docs.reserve(n_docs);
+    invalid = 0;
+    for (std::size_t d = 0; d < n_docs; ++d) {
+        std::string s;
+        const std::size_t statements = 1 + rng.below(8);
+        for (std::size_t i = 0; i < statements; ++i) {
+            s += rng.percent(50) ? "let v" + std::to_string(i) + "=" + std::to_string(d) + ";"
+                                 : "print " + std::to_string(i * d) + ";";
+        }
+        if (rng.percent(error_pct)) {
+            s += rng.pick(breaks);
+            ++invalid;
+        }
+        docs.push_back(std::move(s));
+    }
+    return docs;
+}
+
+// -------------------------------------------------------------------------
+// Adversarial backtracking.
+// -------------------------------------------------------------------------
+
+// Nested lists `(e,e,e)c` for a grammar whose alternatives
+// `list "a" / list "b" / list "c" / "x"` share the inline `list` prefix:
+// every list ends in the LAST alternative's suffix, so each level is parsed
+// three times. `depth` levels of 3-way fan-out; 3^depth leaves `x`.
+inline std::string backtrack_lists(std::size_t depth)
+{
+    if (depth == 0) {
+        return "x";
+    }
+    const std::string inner = backtrack_lists(depth - 1);
+    return "(" + inner + "," + inner + "," + inner + ")c";
+}
+
+// `((((a+(b*(c-...` — N nested parenthesized operations with no closers.
+// Every level's `"(" expr ")"` alternative fails at end of input, after the
+// whole remainder has been parsed, and the diagnostic is at the very end.
+// Approx 3*N bytes.
+inline std::string unclosed_arithmetic(std::size_t depth)
+{
+    static constexpr char ops[] = {'+', '*', '-', '/'};
+    std::string s;
+    s.reserve(3 * depth + 1);
+    for (std::size_t i = 0; i < depth; ++i) {
+        s += '(';
+        s += static_cast<char>('a' + i % 26);
+        s += ops[i % 4];
+    }
+    s += 'z';
+    return s;
+}
+
 } // namespace peglib_bench::fixtures
 
 #endif // PEGLIB_PERF_FIXTURES_HPP
@@ -0,0 +1,929 @@
+// ---------------------------------------------------------------------------
+// peglib benchmark harness: workload registry, repetition statistics,
+// table / JSON / CSV output, and baseline comparison.
+//
+// Workloads register themselves with PEGLIB_BENCH_WORKLOAD(id) at namespace
+// scope and run in registration order (definition order within one file).
+// A workload body builds its grammar and fixtures, then times one or more
+// rows through Runner::run_fn (per call, with MB/s over the input) or
+// Runner::run_ops (per operation, for microbenchmarks):
+//
+//   PEGLIB_BENCH_WORKLOAD(json_wide)
+//   {
+//       JsonWorkload w;
+//       auto input = fixtures::wide_json_array(bench.quick() ? 400 : 4000);
+//       bench.run_fn("json wide array", input.size(), 100, [&] { ... });
+//   }
+//
+// Each row runs `warmup` untimed iterations, then splits its iteration budget
+// into `reps` timed batches. Every batch yields one ns/iteration sample; the
+// row reports min / median / p95 / mean / standard deviation over the
+// samples, and MB/s at the median. Rows not selected by --filter are skipped
+// before their warmup (the workload's setup still runs).
+//
+// A run_ops row is timed the same way, but its samples are divided by the
+// call's op count (ns per op), MB/s is not reported, and the size and the
+// per-unit allocation columns (alloc/u, bytes/u) count ops instead of bytes.
+//
+// After timing, one more (untimed) iteration runs under an AllocScope (see
+// alloc_counter.hpp): heap allocations and bytes per parse, allocations per
+// input byte, and the peak live heap over the iteration. A body that parses
+// one Context reports its arena node count and memo entries through
+// Runner::report_parse() during that iteration (accounting() is true). Peak
+// RSS is the process high-water mark after the row.
+//
+// With --reuse, workloads parse through one Context per row, rebound to the
+// input each iteration (Context::rebind) instead of a fresh one, and a row
+// whose body called expect_no_allocs() fails (`ok` 0) if its accounting
+// iteration allocated anything: after the warmup, such a parse must run
+// entirely on the memory the Context kept.
+//
+// Command line (see usage()):
+//   --quick               smaller inputs and iteration counts (smoke run)
+//   --reps N              timed batches per row (default 5)
+//   --filter TEXT         run only rows whose name contains TEXT (repeatable)
+//   --json | --csv        machine-readable output on stdout
+//   --compare FILE        compare medians against a saved --json run
+//   --threshold PCT       regression threshold for --compare (default 5)
+//   --memory              table shows the memory columns instead of timing
+//   --reuse               reuse one Context per row; check zero allocation
+//   --scaling             run the scaling workloads instead (see below)
+//   --max-exponent X      growth exponent --scaling fails above (default 1.25)
+//
+// The JSON output puts one result object per line; --compare reads that
+// layout back (it is not a general JSON reader). With --compare the exit
+// status is 1 when any row regressed past the threshold (median time, or
+// allocations per parse) or failed its parse,
+// so a script can gate on it. Notes (Runner::note) and the comparison go to
+// stdout in table mode and to stderr otherwise, so machine output stays
+// clean.
+//
+// Scaling (--scaling): workloads registered with PEGLIB_BENCH_SCALING(id)
+// call Runner::scale(name, base_n, make_input, parse), which parses
+// make_input(n) at doubling n (6 sizes, 4 with --quick) and fits the growth
+// exponent k of `time ~ bytes^k` and `allocated bytes ~ bytes^k` by least
+// squares on the log-log points. Time per size is the fastest of `reps`
+// parses. A linear parse fits k ~ 1.0 and n log n about 1.1 over that
+// range; a workload whose time or memory exponent exceeds --max-exponent is
+// reported SUPERLINEAR and the exit status is 1. Table output only.
+// ---------------------------------------------------------------------------
+#ifndef PEGLIB_PERF_HARNESS_HPP
+#define PEGLIB_PERF_HARNESS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "alloc_counter.hpp"
+
+namespace peglib_bench
+{
+
+// -------------------------------------------------------------------------
+// Statistics.
+// -------------------------------------------------------------------------
+struct Stats
+{
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+    double mean = 0;
+    double stddev = 0; // sample standard deviation (0 for a single sample)
+};
+
+// Nearest-rank percentiles over the samples; median interpolates the middle
+// pair for an even count.
+inline Stats summarize(std::vector<double> samples)
+{
+    Stats s;
+    if (samples.empty()) {
+        return s;
+    }
+    std::sort(samples.begin(), samples.end());
+    const std::size_t n = samples.size();
+    s.min = samples.front();
+    s.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    const auto rank = static_cast<std::size_t>(std::ceil(0.95 * static_cast<double>(n)));
+    s.p95 = samples[(rank == 0 ? 1 : rank) - 1];
+    double sum = 0;
+    for (double v : samples) {
+        sum += v;
+    }
+    s.mean = sum / static_cast<double>(n);
+    if (n > 1) {
+        double sq = 0;
+        for (double v : samples) {
+            sq += (v - s.mean) * (v - s.mean);
+        }
+        s.stddev = std::sqrt(sq / static_cast<double>(n - 1));
+    }
+    return s;
+}
+
+struct Result
+{
+    std::string name;
+    std::size_t bytes = 0;
+    std::size_t ops = 0; // >0: microbenchmark row; times and allocs are per op
+    int iters = 0;       // timed iterations in total (over all reps)
+    int reps = 0;
+    Stats ns;            // ns per iteration
+    double mb_per_s = 0; // at the median
+    bool ok = false;
+
+    // Accounting iteration.
+    std::uint64_t allocs = 0;
+    std::uint64_t alloc_bytes = 0;
+    std::int64_t peak_heap = -1;    // bytes over the iteration's start; -1 = untracked
+    std::int64_t nodes = -1;        // -1 = not reported by the workload
+    std::int64_t memo_entries = -1; // -1 = not reported by the workload
+    std::size_t peak_rss = 0;       // process high-water mark, bytes
+
+    // Allocations (and allocated bytes) per input byte, or per op for a
+    // microbenchmark row.
+    [[nodiscard]] double allocs_per_unit() const noexcept { return per_unit(allocs); }
+    [[nodiscard]] double alloc_bytes_per_unit() const noexcept { return per_unit(alloc_bytes); }
+
+    [[nodiscard]] double per_unit(std::uint64_t v) const noexcept
+    {
+        const std::size_t unit = ops != 0 ? ops : bytes;
+        return unit == 0 ? 0 : static_cast<double>(v) / static_cast<double>(unit);
+    }
+};
+
+enum class Format
+{
+    Table,
+    Json,
+    Csv,
+};
+
+struct Options
+{
+    bool quick = false;
+    bool scaling = false;
+    double max_exponent = 1.25;
+    int reps = 5;
+    int warmup = 3;
+    Format format = Format::Table;
+    bool memory_table = false;
+    bool reuse = false;
+    std::vector<std::string> filters;
+    std::string compare_path;
+    double threshold_pct = 5.0;
+};
+
+// One size of a scaling run.
+struct ScalePoint
+{
+    std::size_t n = 0;
+    std::size_t bytes = 0;
+    double ns = 0; // fastest parse
+    std::uint64_t alloc_bytes = 0;
+    bool ok = false;
+};
+
+struct ScalingResult
+{
+    std::string name;
+    std::vector<ScalePoint> points;
+    double time_exponent = 0;
+    double memory_exponent = 0;
+    bool ok = false;
+    bool superlinear = false;
+};
+
+// Least-squares slope of log(y) over log(x).
+inline double fit_exponent(const std::vector<double>& x, const std::vector<double>& y)
+{
+    const std::size_t n = std::min(x.size(), y.size());
+    double sx = 0;
+    double sy = 0;
+    double sxx = 0;
+    double sxy = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double lx = std::log(std::max(x[i], 1.0));
+        const double ly = std::log(std::max(y[i], 1.0));
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    const double denom = static_cast<double>(n) * sxx - sx * sx;
+    return denom == 0 ? 0 : (static_cast<double>(n) * sxy - sx * sy) / denom;
+}
+
+// Input size of a scaling fixture: one document, or a corpus of them.
+inline std::size_t input_bytes(const std::string& input) { return input.size(); }
+inline std::size_t input_bytes(const std::vector<std::string>& corpus)
+{
+    std::size_t bytes = 0;
+    for (const auto& doc : corpus) {
+        bytes += doc.size();
+    }
+    return bytes;
+}
+
+// -------------------------------------------------------------------------
+// Runner: times rows and collects their results.
+// -------------------------------------------------------------------------
+class Runner
+{
+public:
+    explicit Runner(Options options) : m_options{std::move(options)} {}
+
+    [[nodiscard]] bool quick() const noexcept { return m_options.quick; }
+    [[nodiscard]] bool reuse() const noexcept { return m_options.reuse; }
+    [[nodiscard]] const Options& options() const noexcept { return m_options; }
+    [[nodiscard]] const std::vector<Result>& results() const noexcept { return m_results; }
+    [[nodiscard]] const std::vector<ScalingResult>& scaling_results() const noexcept
+    {
+        return m_scaling;
+    }
+
+    // True while the accounting iteration runs; a body may then call
+    // report_parse() with the counters of the Context it parsed.
+    [[nodiscard]] bool accounting() const noexcept { return m_accounting; }
+    void report_parse(std::size_t nodes, std::size_t memo_entries) noexcept
+    {
+        m_nodes = static_cast<std::int64_t>(nodes);
+        m_memo_entries = static_cast<std::int64_t>(memo_entries);
+    }
+
+    // --reuse: the row being timed must not allocate in its accounting
+    // iteration. Call from the body; applies to the current row only.
+    void expect_no_allocs() noexcept { m_expect_no_allocs = true; }
+
+    [[nodiscard]] bool selected(std::string_view name) const
+    {
+        if (m_options.filters.empty()) {
+            return true;
+        }
+        for (const auto& f : m_options.filters) {
+            if (name.find(f) != std::string_view::npos) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Time `iters` calls of `fn()` (after the warmup), split into reps
+    // batches. `fn` returns false on a failed iteration. `bytes` is the input
+    // consumed per call, for MB/s.
+    template<typename Fn>
+    void run_fn(std::string name, std::size_t bytes, int iters, Fn&& fn)
+    {
+        run_impl(std::move(name), bytes, 0, iters, fn);
+    }
+
+    // As run_fn, for a call that performs `ops` operations: times and
+    // allocation counts are reported per op.
+    template<typename Fn>
+    void run_ops(std::string name, std::size_t ops, int iters, Fn&& fn)
+    {
+        run_impl(std::move(name), 0, ops, iters, fn);
+    }
+
+    // --scaling: parse `make_input(n)` for n = base_n, 2*base_n, ... and fit
+    // the time and memory growth exponents over the input size in bytes.
+    // `parse(input)` builds its own Context(s) and returns false on failure.
+    template<typename MakeInput, typename ParseFn>
+    void scale(std::string name, std::size_t base_n, MakeInput make_input, ParseFn parse)
+    {
+        if (!selected(name)) {
+            return;
+        }
+        ScalingResult s;
+        s.name = std::move(name);
+        s.ok = true;
+        const int steps = m_options.quick ? 4 : 6;
+        std::printf("%s\n", s.name.c_str());
+        for (int i = 0; i < steps; ++i) {
+            const auto input = make_input(base_n << i);
+            ScalePoint p;
+            p.n = base_n << i;
+            p.bytes = input_bytes(input);
+            p.ok = parse(input); // warmup
+            p.ns = 0;
+            for (int r = 0; r < std::max(1, m_options.reps); ++r) {
+                const auto t0 = std::chrono::steady_clock::now();
+                p.ok = parse(input) && p.ok;
+                const auto t1 = std::chrono::steady_clock::now();
+                const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+                p.ns = r == 0 ? ns : std::min(p.ns, ns);
+            }
+            AllocScope scope;
+            p.ok = parse(input) && p.ok;
+            p.alloc_bytes = scope.finish().bytes;
+            s.ok = s.ok && p.ok;
+            std::printf("  %10zu %10zu %14.0f %9.2f %12.1f %3d\n",
+                        p.n,
+                        p.bytes,
+                        p.ns,
+                        p.bytes == 0 ? 0.0 : p.ns / static_cast<double>(p.bytes),
+                        static_cast<double>(p.alloc_bytes) / 1024.0,
+                        p.ok ? 1 : 0);
+            s.points.push_back(p);
+        }
+
+        std::vector<double> bytes;
+        std::vector<double> ns;
+        std::vector<double> mem;
+        for (const auto& p : s.points) {
+            bytes.push_back(static_cast<double>(p.bytes));
+            ns.push_back(p.ns);
+            mem.push_back(static_cast<double>(p.alloc_bytes));
+        }
+        s.time_exponent = fit_exponent(bytes, ns);
+        s.memory_exponent = fit_exponent(bytes, mem);
+        s.superlinear = s.time_exponent > m_options.max_exponent ||
+                        s.memory_exponent > m_options.max_exponent;
+        std::printf("  time ~ n^%.2f, memory ~ n^%.2f  %s\n\n",
+                    s.time_exponent,
+                    s.memory_exponent,
+                    !s.ok ? "FAILED" : s.superlinear ? "SUPERLINEAR" : "ok");
+        m_scaling.push_back(std::move(s));
+    }
+
+    static void print_scaling_header()
+    {
+        std::printf("  %10s %10s %14s %9s %12s %3s\n",
+                    "n",
+                    "bytes",
+                    "min ns",
+                    "ns/B",
+                    "alloc KB",
+                    "ok");
+    }
+
+private:
+    template<typename Fn>
+    void run_impl(std::string name, std::size_t bytes, std::size_t ops, int iters, Fn& fn)
+    {
+        if (!selected(name)) {
+            return;
+        }
+        const double per_call = ops != 0 ? static_cast<double>(ops) : 1.0;
+        for (int i = 0; i < m_options.warmup; ++i) {
+            fn();
+        }
+        const int reps = std::max(1, m_options.reps);
+        const int batch = std::max(1, iters / reps);
+        bool all_ok = true;
+        std::vector<double> samples;
+        samples.reserve(static_cast<std::size_t>(reps));
+        for (int r = 0; r < reps; ++r) {
+            const auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < batch; ++i) {
+                if (!fn()) {
+                    all_ok = false;
+                }
+            }
+            const auto t1 = std::chrono::steady_clock::now();
+            samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() /
+                              (static_cast<double>(batch) * per_call));
+        }
+
+        m_nodes = -1;
+        m_memo_entries = -1;
+        m_accounting = true;
+        AllocScope scope;
+        if (!fn()) {
+            all_ok = false;
+        }
+        const AllocCounts counts = scope.finish();
+        m_accounting = false;
+        if (m_expect_no_allocs && counts.allocs != 0) {
+            all_ok = false;
+        }
+        m_expect_no_allocs = false;
+
+        Result r;
+        r.allocs = counts.allocs;
+        r.alloc_bytes = counts.bytes;
+        r.peak_heap = counts.peak_live;
+        r.nodes = m_nodes;
+        r.memo_entries = m_memo_entries;
+        r.peak_rss = peak_rss_bytes();
+        r.name = std::move(name);
+        r.bytes = bytes;
+        r.ops = ops;
+        r.iters = batch * reps;
+        r.reps = reps;
+        r.ns = summarize(std::move(samples));
+        r.mb_per_s = r.ns.median > 0
+                         ? (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (r.ns.median * 1e-9)
+                         : 0;
+        r.ok = all_ok;
+        if (m_options.format == Format::Table) {
+            m_options.memory_table ? print_memory_row(r) : print_row(r);
+        }
+        m_results.push_back(std::move(r));
+    }
+
+public:
+    // Free-form line printed with the results (stdout in table mode,
+    // stderr otherwise).
+    void note(const char* fmt, ...) const
+    {
+        std::va_list args;
+        va_start(args, fmt);
+        std::vfprintf(m_options.format == Format::Table ? stdout : stderr, fmt, args);
+        va_end(args);
+    }
+
+    void print_header() const
+    {
+        char line[256];
+        if (m_options.memory_table) {
+            std::snprintf(line,
+                          sizeof line,
+                          "%-36s %8s %9s %10s %8s %8s %10s %9s %8s %8s",
+                          "workload",
+                          "size",
+                          "allocs",
+                          "alloc KB",
+                          "alloc/u",
+                          "bytes/u",
+                          "peak KB",
+                          "nodes",
+                          "memo",
+                          "RSS MB");
+        } else {
+            std::snprintf(line,
+                          sizeof line,
+                          "%-36s %8s %6s %4s %11s %11s %11s %6s %9s %8s %3s",
+                          "workload",
+                          "size",
+                          "iters",
+                          "reps",
+                          "median ns",
+                          "min ns",
+                          "p95 ns",
+                          "sd%",
+                          "MB/s",
+                          "alloc/u",
+                          "ok");
+        }
+        std::printf("%s\n%s\n", line, std::string(std::strlen(line), '-').c_str());
+    }
+
+    static void print_row(const Result& r)
+    {
+        std::printf("%-36s %8zu %6d %4d %11.1f %11.1f %11.1f %6.1f %9s %8.3f %3d\n",
+                    r.name.c_str(),
+                    r.ops != 0 ? r.ops : r.bytes,
+                    r.iters,
+                    r.reps,
+                    r.ns.median,
+                    r.ns.min,
+                    r.ns.p95,
+                    r.ns.mean > 0 ? 100.0 * r.ns.stddev / r.ns.mean : 0.0,
+                    r.ops != 0 ? "-" : format_rate(r.mb_per_s).c_str(),
+                    r.allocs_per_unit(),
+                    r.ok ? 1 : 0);
+    }
+
+    static std::string format_rate(double v)
+    {
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%.1f", v);
+        return buf;
+    }
+
+    static void print_memory_row(const Result& r)
+    {
+        const auto count = [](std::int64_t v) {
+            return v < 0 ? std::string{"-"} : std::to_string(v);
+        };
+        std::printf("%-36s %8zu %9llu %10.1f %8.3f %8.2f %10s %9s %8s %8.1f\n",
+                    r.name.c_str(),
+                    r.ops != 0 ? r.ops : r.bytes,
+                    static_cast<unsigned long long>(r.allocs),
+                    static_cast<double>(r.alloc_bytes) / 1024.0,
+                    r.allocs_per_unit(),
+                    r.alloc_bytes_per_unit(),
+                    r.peak_heap < 0 ? "-" : std::to_string(r.peak_heap / 1024).c_str(),
+                    count(r.nodes).c_str(),
+                    count(r.memo_entries).c_str(),
+                    static_cast<double>(r.peak_rss) / (1024.0 * 1024.0));
+    }
+
+private:
+    Options m_options;
+    std::vector<Result> m_results;
+    std::vector<ScalingResult> m_scaling;
+    bool m_accounting = false;
+    bool m_expect_no_allocs = false;
+    std::int64_t m_nodes = -1;
+    std::int64_t m_memo_entries = -1;
+};
+
+// -------------------------------------------------------------------------
+// Registry.
+// -------------------------------------------------------------------------
+using WorkloadFn = void (*)(Runner&);
+
+struct Registration
+{
+    const char* id;
+    WorkloadFn fn;
+};
+
+inline std::vector<Registration>& registry()
+{
+    static std::vector<Registration> workloads;
+    return workloads;
+}
+
+// Workloads run only under --scaling.
+inline std::vector<Registration>& scaling_registry()
+{
+    static std::vector<Registration> workloads;
+    return workloads;
+}
+
+struct Registrar
+{
+    Registrar(std::vector<Registration>& to, const char* id, WorkloadFn fn)
+    {
+        to.push_back({id, fn});
+    }
+};
+
+#define PEGLIB_BENCH_REGISTER_(list, id)                                                           \
+    static void peglib_bench_workload_##id(::peglib_bench::Runner& bench);                         \
+    static const ::peglib_bench::Registrar peglib_bench_registrar_##id{                            \
+        ::peglib_bench::list(), #id, &peglib_bench_workload_##id};                                 \
+    static void peglib_bench_workload_##id([[maybe_unused]] ::peglib_bench::Runner& bench)
+
+#define PEGLIB_BENCH_WORKLOAD(id) PEGLIB_BENCH_REGISTER_(registry, id)
+#define PEGLIB_BENCH_SCALING(id) PEGLIB_BENCH_REGISTER_(scaling_registry, id)
+
+// -------------------------------------------------------------------------
+// Output.
+// -------------------------------------------------------------------------
+inline std::string json_escape(std::string_view s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+inline void write_json(std::FILE* out, const Options& options, const std::vector<Result>& results)
+{
+    std::fprintf(out,
+                 "{\n  \"peglib_bench\": 1,\n  \"quick\": %s,\n  \"results\": [\n",
+                 options.quick ? "true" : "false");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(out,
+                     "    {\"name\": \"%s\", \"bytes\": %zu, \"ops\": %zu, \"iters\": %d, "
+                     "\"reps\": %d, \"min_ns\": %.1f, \"median_ns\": %.1f, \"p95_ns\": %.1f, "
+                     "\"mean_ns\": %.1f, \"stddev_ns\": %.1f, \"mb_per_s\": %.2f, "
+                     "\"allocs\": %llu, \"alloc_bytes\": %llu, \"allocs_per_byte\": %.4f, "
+                     "\"allocs_per_op\": %.4f, \"peak_heap_bytes\": %lld, \"nodes\": %lld, "
+                     "\"memo_entries\": %lld, \"peak_rss_bytes\": %zu, \"ok\": %s}%s\n",
+                     json_escape(r.name).c_str(),
+                     r.bytes,
+                     r.ops,
+                     r.iters,
+                     r.reps,
+                     r.ns.min,
+                     r.ns.median,
+                     r.ns.p95,
+                     r.ns.mean,
+                     r.ns.stddev,
+                     r.mb_per_s,
+                     static_cast<unsigned long long>(r.allocs),
+                     static_cast<unsigned long long>(r.alloc_bytes),
+                     r.bytes != 0 ? r.allocs_per_unit() : 0.0,
+                     r.ops != 0 ? r.allocs_per_unit() : 0.0,
+                     static_cast<long long>(r.peak_heap),
+                     static_cast<long long>(r.nodes),
+                     static_cast<long long>(r.memo_entries),
+                     r.peak_rss,
+                     r.ok ? "true" : "false",
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+}
+
+inline void write_csv(std::FILE* out, const std::vector<Result>& results)
+{
+    std::fprintf(out,
+                 "name,bytes,ops,iters,reps,min_ns,median_ns,p95_ns,mean_ns,stddev_ns,mb_per_s,"
+                 "allocs,alloc_bytes,allocs_per_byte,allocs_per_op,peak_heap_bytes,nodes,"
+                 "memo_entries,peak_rss_bytes,ok\n");
+    for (const Result& r : results) {
+        std::string quoted;
+        for (char c : r.name) {
+            quoted += c;
+            if (c == '"') {
+                quoted += '"';
+            }
+        }
+        std::fprintf(out,
+                     "\"%s\",%zu,%zu,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.2f,"
+                     "%llu,%llu,%.4f,%.4f,%lld,%lld,%lld,%zu,%d\n",
+                     quoted.c_str(),
+                     r.bytes,
+                     r.ops,
+                     r.iters,
+                     r.reps,
+                     r.ns.min,
+                     r.ns.median,
+                     r.ns.p95,
+                     r.ns.mean,
+                     r.ns.stddev,
+                     r.mb_per_s,
+                     static_cast<unsigned long long>(r.allocs),
+                     static_cast<unsigned long long>(r.alloc_bytes),
+                     r.bytes != 0 ? r.allocs_per_unit() : 0.0,
+                     r.ops != 0 ? r.allocs_per_unit() : 0.0,
+                     static_cast<long long>(r.peak_heap),
+                     static_cast<long long>(r.nodes),
+                     static_cast<long long>(r.memo_entries),
+                     r.peak_rss,
+                     r.ok ? 1 : 0);
+    }
+}
+
+// -------------------------------------------------------------------------
+// Baseline comparison.
+// -------------------------------------------------------------------------
+struct BaselineEntry
+{
+    std::string name;
+    double median_ns = 0;
+    double allocs = -1; // -1 = not in the baseline (older file)
+};
+
+struct Baseline
+{
+    bool quick = false;
+    std::vector<BaselineEntry> entries;
+};
+
+// Reads the one-result-per-line layout written by write_json().
+inline bool read_baseline(const std::string& path, Baseline& out)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("\"quick\": true") != std::string::npos) {
+            out.quick = true;
+        }
+        const auto key = line.find("{\"name\": \"");
+        if (key == std::string::npos) {
+            continue;
+        }
+        BaselineEntry e;
+        std::size_t i = key + 10;
+        for (; i < line.size() && line[i] != '"'; ++i) {
+            if (line[i] == '\\' && i + 1 < line.size()) {
+                ++i;
+            }
+            e.name += line[i];
+        }
+        const auto med = line.find("\"median_ns\": ", i);
+        if (med == std::string::npos) {
+            continue;
+        }
+        e.median_ns = std::strtod(line.c_str() + med + 13, nullptr);
+        const auto allocs = line.find("\"allocs\": ", i);
+        if (allocs != std::string::npos) {
+            e.allocs = std::strtod(line.c_str() + allocs + 10, nullptr);
+        }
+        out.entries.push_back(std::move(e));
+    }
+    return true;
+}
+
+// Prints one line per current row and returns the number of rows that
+// regressed past the threshold (or failed their parse). Allocation counts
+// are deterministic, so they are compared against the same threshold
+// without any noise allowance.
+inline int compare(std::FILE* out,
+                   const Baseline& base,
+                   const std::vector<Result>& results,
+                   const Options& options)
+{
+    if (base.quick != options.quick) {
+        std::fprintf(out,
+                     "warning: baseline was %s run, this is %s run\n",
+                     base.quick ? "a --quick" : "a full",
+                     options.quick ? "a --quick" : "a full");
+    }
+    std::fprintf(out,
+                 "\n%-36s %11s %11s %8s %8s  %s\n",
+                 "workload",
+                 "base ns",
+                 "median ns",
+                 "delta",
+                 "allocs",
+                 "status");
+    int bad = 0;
+    for (const Result& r : results) {
+        const BaselineEntry* b = nullptr;
+        for (const auto& e : base.entries) {
+            if (e.name == r.name) {
+                b = &e;
+                break;
+            }
+        }
+        if (b == nullptr || b->median_ns <= 0) {
+            std::fprintf(out,
+                         "%-36s %11s %11.0f %8s %8s  %s\n",
+                         r.name.c_str(),
+                         "-",
+                         r.ns.median,
+                         "-",
+                         "-",
+                         r.ok ? "new" : "FAILED");
+            bad += r.ok ? 0 : 1;
+            continue;
+        }
+        const double delta = 100.0 * (r.ns.median - b->median_ns) / b->median_ns;
+        const double alloc_delta =
+            b->allocs > 0
+                ? 100.0 * (static_cast<double>(r.allocs) - b->allocs) / b->allocs
+                : 0.0;
+        const char* status = "ok";
+        if (!r.ok) {
+            status = "FAILED";
+            ++bad;
+        } else if (delta > options.threshold_pct) {
+            status = "REGRESSED";
+            ++bad;
+        } else if (alloc_delta > options.threshold_pct) {
+            status = "ALLOCS REGRESSED";
+            ++bad;
+        } else if (delta < -options.threshold_pct) {
+            status = "improved";
+        }
+        std::fprintf(out,
+                     "%-36s %11.0f %11.0f %+7.1f%% %+7.1f%%  %s\n",
+                     r.name.c_str(),
+                     b->median_ns,
+                     r.ns.median,
+                     delta,
+                     alloc_delta,
+                     status);
+    }
+    for (const auto& e : base.entries) {
+        const bool present = std::any_of(
+            results.begin(), results.end(), [&](const Result& r) { return r.name == e.name; });
+        if (!present && options.filters.empty()) {
+            std::fprintf(out,
+                         "%-36s %11.0f %11s %8s %8s  %s\n",
+                         e.name.c_str(),
+                         e.median_ns,
+                         "-",
+                         "-",
+                         "-",
+                         "missing");
+        }
+    }
+    return bad;
+}
+
+// -------------------------------------------------------------------------
+// main.
+// -------------------------------------------------------------------------
+inline void usage(const char* argv0)
+{
+    std::fprintf(stderr,
+                 "usage: %s [--quick] [--reps N] [--filter TEXT]... [--json | --csv | --memory]\n"
+                 "          [--reuse] [--compare BASELINE.json] [--threshold PCT]\n"
+                 "          [--scaling [--max-exponent X]]\n",
+                 argv0);
+}
+
+// Parses the command line into `options`; false on a bad argument.
+inline bool parse_args(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--json") {
+            options.format = Format::Json;
+        } else if (arg == "--csv") {
+            options.format = Format::Csv;
+        } else if (arg == "--memory") {
+            options.memory_table = true;
+        } else if (arg == "--reuse") {
+            options.reuse = true;
+        } else if (arg == "--scaling") {
+            options.scaling = true;
+        } else if (arg == "--max-exponent" && has_value) {
+            options.max_exponent = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--reps" && has_value) {
+            options.reps = std::atoi(argv[++i]);
+            if (options.reps < 1) {
+                return false;
+            }
+        } else if (arg == "--filter" && has_value) {
+            options.filters.emplace_back(argv[++i]);
+        } else if (arg == "--compare" && has_value) {
+            options.compare_path = argv[++i];
+        } else if (arg == "--threshold" && has_value) {
+            options.threshold_pct = std::strtod(argv[++i], nullptr);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --scaling: runs the scaling workloads; status 1 if any grew superlinearly
+// or failed.
+inline int run_scaling(Runner& runner)
+{
+    Runner::print_scaling_header();
+    for (const auto& w : scaling_registry()) {
+        w.fn(runner);
+    }
+    int bad = 0;
+    for (const auto& s : runner.scaling_results()) {
+        if (!s.ok || s.superlinear) {
+            std::printf("%s: %s (time ~ n^%.2f, memory ~ n^%.2f)\n",
+                        s.ok ? "SUPERLINEAR" : "FAILED",
+                        s.name.c_str(),
+                        s.time_exponent,
+                        s.memory_exponent);
+            ++bad;
+        }
+    }
+    std::printf("%d workload(s) grew faster than n^%.2f or failed\n",
+                bad,
+                runner.options().max_exponent);
+    return bad == 0 ? 0 : 1;
+}
+
+// Runs every registered workload and reports. Returns the process status.
+inline int run_main(int argc, char** argv, Options options = {})
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+    }
+    if (!parse_args(argc, argv, options)) {
+        usage(argv[0]);
+        return 2;
+    }
+    Baseline base;
+    if (!options.compare_path.empty() && !read_baseline(options.compare_path, base)) {
+        std::fprintf(stderr, "cannot read baseline '%s'\n", options.compare_path.c_str());
+        return 2;
+    }
+
+    Runner runner{options};
+    if (options.scaling) {
+        return run_scaling(runner);
+    }
+    if (options.format == Format::Table) {
+        runner.print_header();
+    }
+    for (const auto& w : registry()) {
+        w.fn(runner);
+    }
+    if (options.format == Format::Json) {
+        write_json(stdout, options, runner.results());
+    } else if (options.format == Format::Csv) {
+        write_csv(stdout, runner.results());
+    }
+
+    if (options.compare_path.empty()) {
+        return 0;
+    }
+    std::FILE* out = options.format == Format::Table ? stdout : stderr;
+    const int bad = compare(out, base, runner.results(), options);
+    std::fprintf(out, "%d row(s) regressed beyond %.1f%% or failed\n", bad, options.threshold_pct);
+    return bad == 0 ? 0 : 1;
+}
+
+} // namespace peglib_bench
+
+#endif // PEGLIB_PERF_HARNESS_HPP
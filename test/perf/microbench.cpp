@@ -0,0 +1,326 @@
+// ---------------------------------------------------------------------------
+// peglib per-combinator microbenchmarks.
+//
+// peglib_bench times whole grammars; a regression there says THAT parsing got
+// slower, not WHERE. Each row here isolates one combinator or one Context
+// operation and reports ns per operation, so the cost of a single
+// TerminalExpr, a sequence step, an alternation miss, a memo hit, the
+// skipper, make_node or remove_cut can be tracked on its own.
+//
+// Every row is one Runner::run_ops call: the body performs `ops` operations
+// on a fresh Context (constructed inside the call, so its cost is amortized
+// over the ops) and the harness divides the batch time by the op count. The
+// accounting iteration reports allocations per op. Expressions are built
+// once outside the timed loop and invoked directly through parse(), with no
+// Grammar entry point in between — except the skipper rows, which need one
+// to install the skipper.
+//
+// Composite rows include their children: "sequence a >> b" is two terminal
+// hits plus the sequence overhead, so the overhead of a combinator is its
+// row minus the rows of what it wraps (see test/perf/BASELINE.md).
+//
+// Shares the harness with peglib_bench (--quick, --reps, --filter, --json,
+// --csv, --compare, --memory). Not a test — never registered with ctest.
+// ---------------------------------------------------------------------------
+#include "peglib.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "harness.hpp"
+
+using namespace peg;
+
+namespace
+{
+
+using Ctx = Context<char>;
+using peglib_bench::Runner;
+
+// Operations per timed call, and calls per row. Ops are sized so one call
+// is well above the steady_clock granularity; --quick divides both by 10.
+struct Sizes
+{
+    std::size_t ops;
+    std::size_t memo_ops; // remove_cut rows: each op scans the memo
+    int iters;
+};
+
+Sizes sizes(const Runner& bench)
+{
+    if (bench.quick()) {
+        return {1000, 200, 20};
+    }
+    return {10000, 2000, 200};
+}
+
+// Time `body(ctx)` as `ops` operations over a fresh Context on `input`.
+template<typename Body>
+void run_ops(Runner& bench,
+             const char* name,
+             std::string_view input,
+             std::size_t ops,
+             int iters,
+             Body body)
+{
+    bench.run_ops(name, ops, iters, [&] {
+        Ctx ctx{input};
+        return body(ctx);
+    });
+}
+
+// `expr` must match once per position of `input` (ops = input length).
+template<typename Expr>
+void run_hits(Runner& bench,
+              const char* name,
+              const Expr& expr,
+              std::string_view input,
+              std::size_t ops,
+              int iters)
+{
+    run_ops(bench, name, input, ops, iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < ops; ++i) {
+            if (!expr.parse(ctx)) {
+                return false;
+            }
+        }
+        return ctx.ended();
+    });
+}
+
+// `expr` must fail at every position of `input`; each op re-positions first.
+template<typename Expr>
+void run_misses(Runner& bench,
+                const char* name,
+                const Expr& expr,
+                std::string_view input,
+                ErrorTracking tracking,
+                int iters)
+{
+    run_ops(bench, name, input, input.size(), iters, [&](Ctx& ctx) {
+        ctx.error_tracking(tracking);
+        for (std::size_t i = 0; i < input.size(); ++i) {
+            ctx.reset(i);
+            if (expr.parse(ctx)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+std::string repeat(std::string_view unit, std::size_t n)
+{
+    std::string s;
+    s.reserve(unit.size() * n);
+    for (std::size_t i = 0; i < n; ++i) {
+        s += unit;
+    }
+    return s;
+}
+
+// -------------------------------------------------------------------------
+// Leaves.
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_WORKLOAD(terminals)
+{
+    const Sizes s = sizes(bench);
+    Grammar<> g;
+    const std::string as(s.ops, 'a');
+    const std::string bs(s.ops, 'b');
+
+    auto a = g.terminal('a');
+    run_hits(bench, "terminal hit", a, as, s.ops, s.iters);
+    run_misses(bench, "terminal miss (tracking full)", a, bs, ErrorTracking::Full, s.iters);
+    run_misses(bench, "terminal miss (tracking off)", a, bs, ErrorTracking::Off, s.iters);
+
+    auto range = g.terminal('a', 'z');
+    run_hits(bench, "terminal range hit", range, as, s.ops, s.iters);
+
+    const std::string words = repeat("abcd", s.ops);
+    run_hits(bench, "terminalSeq hit (4 chars)", g.terminalSeq("abcd"), words, s.ops, s.iters);
+
+    auto one = g.matcher([](Ctx& c, Span sp) -> std::optional<Span> {
+        if (!c.ended() && c.current() == 'a') {
+            return Span{sp.start, sp.start + 1};
+        }
+        return std::nullopt;
+    });
+    run_hits(bench, "matcher one char", one, as, s.ops, s.iters);
+}
+
+// -------------------------------------------------------------------------
+// Combinators.
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_WORKLOAD(combinators)
+{
+    const Sizes s = sizes(bench);
+    Grammar<> g;
+    const std::string as(s.ops, 'a');
+    const std::string abs = repeat("ab", s.ops);
+
+    run_hits(bench, "sequence a >> b", g.terminal('a') >> g.terminal('b'), abs, s.ops, s.iters);
+    run_hits(bench,
+             "alternation first-branch hit",
+             g.terminal('a') | g.terminal('b'),
+             as,
+             s.ops,
+             s.iters);
+    run_hits(bench,
+             "alternation miss then hit",
+             g.terminal('b') | g.terminal('a'),
+             as,
+             s.ops,
+             s.iters);
+
+    // One call matches the whole input: ops = elements.
+    auto star = *g.terminal('a');
+    run_ops(bench, "repetition per element", as, s.ops, s.iters, [&](Ctx& ctx) {
+        return star.parse(ctx) && ctx.ended();
+    });
+}
+
+// -------------------------------------------------------------------------
+// NonTerminal: memo miss (every position is new) and memo hit (the same
+// position replayed).
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_WORKLOAD(nonterminal)
+{
+    const Sizes s = sizes(bench);
+    Grammar<> g;
+    g["r"] = g.terminal('a');
+    const Grammar<>::Rule r = g["r"];
+    const std::string as(s.ops, 'a');
+
+    run_hits(bench, "nonterminal memo miss", r, as, s.ops, s.iters);
+    run_ops(bench, "nonterminal memo hit", as, s.ops, s.iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            ctx.reset(0);
+            if (!r.parse(ctx)) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+// -------------------------------------------------------------------------
+// Skipper: the same rule-level repetition with and without a whitespace
+// skipper between elements; the difference is the per-element skip cost.
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_WORKLOAD(skipper)
+{
+    const Sizes s = sizes(bench);
+    Grammar<> plain;
+    plain["item"] = plain.terminal('a');
+    plain["list"] = *plain["item"];
+
+    Grammar<> skipping;
+    skipping["ws"] = *skipping.terminal(' ');
+    skipping["item"] = skipping.terminal('a');
+    skipping["list"] = *skipping["item"];
+    skipping.set_skipper(skipping["ws"]);
+
+    const std::string as(s.ops, 'a');
+    std::string spaced = repeat("a ", s.ops);
+    spaced.pop_back(); // no trailing separator: the parse must end the input
+    run_ops(bench, "rule repetition (no skipper)", as, s.ops, s.iters, [&](Ctx& ctx) {
+        return plain.parse("list", ctx) && ctx.ended();
+    });
+    run_ops(bench, "rule repetition (skipper)", spaced, s.ops, s.iters, [&](Ctx& ctx) {
+        return skipping.parse("list", ctx) && ctx.ended();
+    });
+}
+
+// -------------------------------------------------------------------------
+// Context operations the combinators are built on.
+// -------------------------------------------------------------------------
+PEGLIB_BENCH_WORKLOAD(context_ops)
+{
+    const Sizes s = sizes(bench);
+    Grammar<> g;
+    g["r"] = g.terminal('a');
+    const Ctx::NonTerminalType* rule = g["r"].impl();
+    const std::string as(s.ops, 'a');
+
+    run_ops(bench, "context make_node", as, s.ops, s.iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            ctx.make_node()->end_offset = i;
+        }
+        return ctx.node_count() == s.ops;
+    });
+
+    run_ops(bench, "context rule_state insert", as, s.ops, s.iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            if (!std::get<0>(ctx.rule_state(rule, i))) {
+                return false;
+            }
+        }
+        return true;
+    });
+    run_ops(bench, "context rule_state hit", as, s.ops, s.iters, [&](Ctx& ctx) {
+        (void)ctx.rule_state(rule, 0);
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            if (std::get<0>(ctx.rule_state(rule, 0))) {
+                return false;
+            }
+        }
+        return true;
+    });
+
+    // record_failure_lazy: a new furthest position (the expected set is
+    // reset and the producer runs), a tie (the producer runs, the set
+    // deduplicates), and a position behind the furthest (nothing runs).
+    const auto producer = [] { return ExpectedItem{ExpectedKind::Literal, "'a'"}; };
+    run_ops(bench, "record_failure_lazy furthest", as, s.ops, s.iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            ctx.record_failure_lazy(i, producer);
+        }
+        return ctx.furthest_failure_pos() == s.ops - 1;
+    });
+    run_ops(bench, "record_failure_lazy tied", as, s.ops, s.iters, [&](Ctx& ctx) {
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            ctx.record_failure_lazy(0, producer);
+        }
+        return ctx.expected().size() == 1;
+    });
+    run_ops(bench, "record_failure_lazy behind", as, s.ops, s.iters, [&](Ctx& ctx) {
+        ctx.record_failure_lazy(s.ops, producer);
+        for (std::size_t i = 0; i < s.ops; ++i) {
+            ctx.record_failure_lazy(i, producer);
+        }
+        return ctx.furthest_failure_pos() == s.ops;
+    });
+
+    // remove_cut: each op commits a cut one position further over a memo
+    // holding an entry per position, so the memo shrinks by one entry per op
+    // and the row measures what a commit costs against a populated memo.
+    const std::string memo_input(s.memo_ops + 1, 'a');
+    run_ops(bench,
+            "context remove_cut (populated memo)",
+            memo_input,
+            s.memo_ops,
+            s.iters,
+            [&](Ctx& ctx) {
+                for (std::size_t i = 0; i < s.memo_ops; ++i) {
+                    (void)ctx.rule_state(rule, i);
+                }
+                for (std::size_t i = 0; i < s.memo_ops; ++i) {
+                    ctx.reset(i);
+                    ctx.init_cut();
+                    ctx.next();
+                    ctx.cut(true);
+                    ctx.remove_cut();
+                }
+                return ctx.memo_entry_count() == 0;
+            });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    return peglib_bench::run_main(argc, argv);
+}
@@ -0,0 +1,208 @@
+// ---------------------------------------------------------------------------
+// RuleProfiler test suite.
+//
+// Covers:
+//   - Exact mode: folded stacks name the rule paths, one `path ns` line each.
+//   - Per-rule calls (memo hits included) and recursion counted once in a
+//     rule's total.
+//   - The shadow stack unwinds on failed and cut-committed parses.
+//   - The skipper's applications appear as their own root path.
+//   - Rule names are made safe for the folded format.
+//   - Sampling mode records samples and shares the output format.
+//   - A detached Context parses exactly as before.
+// ---------------------------------------------------------------------------
+
+#include "peglib.h"
+
+#include "doctest.h"
+
+#include <chrono>
+#include <cstddef>
+#include <sstream>
+#include <string>
+
+using namespace peg;
+
+namespace
+{
+// expr <- term ('+' term)*; term <- factor ('*' factor)*;
+// factor <- [0-9] / '(' expr ')'
+void arith(Grammar<char>& g)
+{
+    g["factor"] = g.terminal('0', '9') | g.terminal('(') >> g["expr"] >> g.terminal(')');
+    g["term"] = g["factor"] >> *(g.terminal('*') >> g["factor"]);
+    g["expr"] = g["term"] >> *(g.terminal('+') >> g["term"]);
+}
+
+const RuleProfiler::RuleStats* find(const std::vector<RuleProfiler::RuleStats>& rules,
+                                    const std::string& name)
+{
+    for (const auto& r : rules) {
+        if (r.name == name) {
+            return &r;
+        }
+    }
+    return nullptr;
+}
+
+// Every line is `frame(;frame)* <positive integer>`.
+bool well_formed(const std::string& folded)
+{
+    std::istringstream in{folded};
+    std::string line;
+    while (std::getline(in, line)) {
+        const auto space = line.rfind(' ');
+        if (space == std::string::npos || space == 0 || space + 1 == line.size()) {
+            return false;
+        }
+        if (line.find(' ') != space ||
+            line.find_first_not_of("0123456789", space + 1) != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("profiler: exact mode folds rule paths")
+{
+    Grammar<char> g;
+    arith(g);
+    const std::string in = "1+(2*3)+4";
+    Grammar<char>::Context ctx{in};
+    RuleProfiler prof;
+    CHECK_FALSE(prof.sampling());
+    ctx.profiler(&prof);
+    REQUIRE(g.parse("expr", ctx));
+    CHECK(ctx.ended());
+
+    const std::string folded = prof.folded_stacks();
+    CHECK(well_formed(folded));
+    CHECK(folded.find("expr;term;factor ") != std::string::npos);
+    CHECK(folded.find("expr;term;factor;expr;term;factor ") != std::string::npos);
+
+    const auto rules = prof.rules();
+    REQUIRE(rules.size() == 3);
+    CHECK(rules[0].self_ns >= rules[1].self_ns); // hottest first
+    const auto* expr = find(rules, "expr");
+    const auto* factor = find(rules, "factor");
+    REQUIRE(expr);
+    REQUIRE(factor);
+    // At least one application per match; the seed-grow loop's second pass
+    // over each body adds memo hits on top.
+    CHECK(expr->calls >= 2);
+    CHECK(factor->calls >= 4);
+    // Recursion is counted once: expr's total is the outer application's.
+    CHECK(expr->total_ns >= expr->self_ns);
+    CHECK(expr->total_ns >= factor->total_ns);
+}
+
+TEST_CASE("profiler: memo hits count as calls")
+{
+    // `a` is tried by the first alternative, then replayed from the memo by
+    // the second.
+    Grammar<char> g;
+    g["a"] = g.terminal('a');
+    g["s"] = g["a"] >> g.terminal('x') | g["a"] >> g.terminal('y');
+    const std::string in = "ay";
+    Grammar<char>::Context ctx{in};
+    RuleProfiler prof;
+    ctx.profiler(&prof);
+    REQUIRE(g.parse("s", ctx));
+    const auto rules = prof.rules();
+    const auto* a = find(rules, "a");
+    const auto* s = find(rules, "s");
+    REQUIRE(a);
+    REQUIRE(s);
+    CHECK(a->calls >= 2);
+    CHECK(a->calls > s->calls);
+}
+
+TEST_CASE("profiler: the stack unwinds on failure and cut")
+{
+    Grammar<char> g;
+    g["digit"] = g.terminal('0', '9');
+    g["stmt"] = g.terminal('!') >> g.cut() >> g["digit"] | g["digit"];
+    g["prog"] = +g["stmt"];
+    RuleProfiler prof;
+    for (const std::string in : {"!x", "x", "!1"}) {
+        Grammar<char>::Context ctx{in};
+        ctx.profiler(&prof);
+        (void)g.parse("prog", ctx);
+    }
+    // Every parse's paths hang off `prog`: none is nested under a frame
+    // left open by an earlier failure.
+    const std::string folded = prof.folded_stacks();
+    CHECK(well_formed(folded));
+    CHECK(folded.find("prog;prog") == std::string::npos);
+    const auto rules = prof.rules();
+    const auto* prog = find(rules, "prog");
+    REQUIRE(prog);
+    CHECK(prog->calls == 3);
+}
+
+TEST_CASE("profiler: skipper and rule names")
+{
+    Grammar<char> g;
+    g["white space"] = *g.terminal(' ');
+    g["a;b"] = g.terminal('a');
+    g["list"] = +g["a;b"];
+    g.set_skipper(g["white space"]);
+    const std::string in = "  a a a";
+    Grammar<char>::Context ctx{in};
+    RuleProfiler prof;
+    ctx.profiler(&prof);
+    REQUIRE(g.parse("list", ctx));
+
+    const std::string folded = prof.folded_stacks();
+    CHECK(well_formed(folded));
+    CHECK(folded.find("white_space ") != std::string::npos); // leading skip, a root
+    CHECK(folded.find("list;a:b ") != std::string::npos);
+    const auto rules = prof.rules();
+    CHECK(find(rules, "white space") != nullptr); // rules() keeps the name
+
+    prof.clear();
+    CHECK(prof.rules().empty());
+    CHECK(prof.folded_stacks().empty());
+}
+
+TEST_CASE("profiler: sampling mode")
+{
+    Grammar<char> g;
+    arith(g);
+    std::string in = "1";
+    for (int i = 0; i < 20000; ++i) {
+        in += i % 2 ? "+(2*3)" : "*4";
+    }
+    RuleProfiler prof{std::chrono::microseconds{20}};
+    CHECK(prof.sampling());
+    // Parse until the ticker has fired at least once during a parse.
+    for (int i = 0; i < 50 && prof.folded_stacks().empty(); ++i) {
+        Grammar<char>::Context ctx{in};
+        ctx.profiler(&prof);
+        REQUIRE(g.parse("expr", ctx));
+    }
+    const std::string folded = prof.folded_stacks();
+    CHECK_FALSE(folded.empty());
+    CHECK(well_formed(folded));
+    CHECK(folded.rfind("expr", 0) == 0); // every path starts at the root rule
+    const auto rules = prof.rules();
+    const auto* expr = find(rules, "expr");
+    REQUIRE(expr);
+    CHECK(expr->total_ns > 0);
+}
+
+TEST_CASE("profiler: detached Context is unaffected")
+{
+    Grammar<char> g;
+    arith(g);
+    const std::string in = "1+(2*3";
+    Grammar<char>::Context plain{in};
+    CHECK(plain.profiler() == nullptr);
+    Grammar<char>::Context profiled{in};
+    RuleProfiler prof;
+    profiled.profiler(&prof);
+    CHECK(g.parse("expr", plain) == g.parse("expr", profiled));
+    CHECK(plain.mark() == profiled.mark());
+    CHECK(plain.furthest_failure_pos() == profiled.furthest_failure_pos());
+}
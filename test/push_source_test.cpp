@@ -0,0 +1,201 @@
+// ---------------------------------------------------------------------------
+// PushSource + Grammar::parse_async tests.
+//
+// A push-fed Context grows as input arrives. parse_async must report
+// NeedMoreInput (not failure) while the answer depends on the unfed tail,
+// produce the same tree as a one-shot parse once the input is complete, and
+// re-parse only the frontier on each retry (memo entries that never reached
+// the buffered end replay instead of re-running).
+// ---------------------------------------------------------------------------
+#include "peglib.h"
+
+#include "doctest.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace peg;
+
+namespace
+{
+using Ctx = Context<char>;
+
+void feed(Ctx& ctx, std::string_view s)
+{
+    ctx.feed(s);
+}
+
+// list = '[' item (',' item)* ']'   item = [0-9]+
+struct ListGrammar
+{
+    Grammar<> g;
+    ListGrammar()
+    {
+        g["item"] = +g.terminal('0', '9');
+        g["list"] = g.terminal('[') >> g["item"] >> *(g.terminal(',') >> g["item"]) >>
+                    g.terminal(']');
+        g.set_start("list");
+    }
+};
+} // namespace
+
+TEST_CASE("push: parse_async needs more input until the message is complete")
+{
+    ListGrammar lg;
+    auto ctx = from_push<char>();
+
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    feed(ctx, "[12,3");
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    feed(ctx, "4,");
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    feed(ctx, "5]");
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::Matched);
+    CHECK(ctx.mark() == 9);
+
+    // The tree is one memo hit away and matches a one-shot parse.
+    ctx.reset(0);
+    auto tree = lg.g.parse_tree("list", ctx);
+    REQUIRE(tree);
+    CHECK(tree->end_offset == 9);
+
+    const std::string whole = "[12,34,5]";
+    Ctx ref{whole};
+    auto ref_tree = lg.g.parse_tree("list", ref);
+    REQUIRE(ref_tree);
+    CHECK(ref_tree->children.size() == tree->children.size());
+}
+
+TEST_CASE("push: failure before the buffered end is definitive")
+{
+    ListGrammar lg;
+    auto ctx = from_push<char>();
+    feed(ctx, "[1;");
+    // ';' rules the rule out without looking at the end of the buffer.
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::Failed);
+    auto err = ctx.take_error();
+    REQUIRE(err);
+    CHECK(err->position() == 2);
+}
+
+TEST_CASE("push: close_input makes an incomplete message a failure")
+{
+    ListGrammar lg;
+    auto ctx = from_push<char>();
+    feed(ctx, "[1,2");
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    ctx.close_input();
+    CHECK(lg.g.parse_async(ctx) == ParseStatus::Failed);
+    auto err = ctx.take_error();
+    REQUIRE(err);
+    CHECK(err->position() == 4);
+}
+
+TEST_CASE("push: a match that could still grow waits for more input")
+{
+    Grammar<> g;
+    g["num"] = +g.terminal('0', '9');
+    g.set_start("num");
+
+    auto ctx = from_push<char>();
+    feed(ctx, "123");
+    CHECK(g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    feed(ctx, "45 ");
+    CHECK(g.parse_async(ctx) == ParseStatus::Matched);
+    CHECK(ctx.mark() == 5);
+}
+
+TEST_CASE("push: resume re-parses only the frontier")
+{
+    // item = matcher(letters) ';'. The matcher logs the position it runs at;
+    // an item that completed before the buffered end must not run again.
+    std::vector<std::size_t> calls;
+    Grammar<> g;
+    auto letters = g.matcher([&calls](Ctx& c, Span sp) -> std::optional<Span> {
+        calls.push_back(sp.start);
+        std::size_t end = sp.start;
+        while (!c.ended_at(end) && c.at(end) >= 'a' && c.at(end) <= 'z') {
+            ++end;
+        }
+        if (end == sp.start)
+            return std::nullopt;
+        return Span{sp.start, end};
+    });
+    g["item"] = letters >> g.terminal(';');
+    g["doc"] = *g["item"] >> g.terminal('.');
+    g.set_start("doc");
+
+    auto count_at = [&calls](std::size_t pos) {
+        return std::count(calls.begin(), calls.end(), pos);
+    };
+
+    auto ctx = from_push<char>();
+    feed(ctx, "ab;cd;e");
+    CHECK(g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+    const auto first_at_0 = count_at(0);
+    const auto first_at_3 = count_at(3);
+    const auto first_at_6 = count_at(6);
+    REQUIRE(first_at_0 > 0);
+    REQUIRE(first_at_6 > 0);
+
+    feed(ctx, "f;.");
+    CHECK(g.parse_async(ctx) == ParseStatus::Matched);
+    CHECK(ctx.mark() == 10);
+
+    // Completed items replay from the memo; only the frontier item re-runs.
+    CHECK(count_at(0) == first_at_0);
+    CHECK(count_at(3) == first_at_3);
+    CHECK(count_at(6) > first_at_6);
+}
+
+TEST_CASE("push: a cut failure that reached the buffered end is retried")
+{
+    // The cut sits at the very start of the alternative, so the failure is
+    // committed at the rule's own position.
+    Grammar<> g;
+    g["r"] = (g.cut() >> g.terminalSeq(std::string("bc"))) | g.terminal('x');
+    g["s"] = g["r"];
+    g["t"] = g.terminal('a') >> g["r"];
+
+    SUBCASE("at the start of input")
+    {
+        g.set_start("s");
+        auto ctx = from_push<char>();
+        feed(ctx, "b");
+        CHECK(g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+        feed(ctx, "c");
+        ctx.close_input();
+        CHECK(g.parse_async(ctx) == ParseStatus::Matched);
+        CHECK(ctx.mark() == 2);
+    }
+    SUBCASE("after a prefix")
+    {
+        g.set_start("t");
+        auto ctx = from_push<char>();
+        feed(ctx, "ab");
+        CHECK(g.parse_async(ctx) == ParseStatus::NeedMoreInput);
+        feed(ctx, "c");
+        ctx.close_input();
+        CHECK(g.parse_async(ctx) == ParseStatus::Matched);
+        CHECK(ctx.mark() == 3);
+    }
+    SUBCASE("a committed failure before the end stays a failure")
+    {
+        g.set_start("s");
+        auto ctx = from_push<char>();
+        feed(ctx, "bd");
+        CHECK(g.parse_async(ctx) == ParseStatus::Failed);
+    }
+}
+
+TEST_CASE("push: feed and close_input reject non-push sources")
+{
+    const std::string input = "abc";
+    Ctx ctx{input};
+    CHECK_FALSE(ctx.input_open());
+    CHECK_THROWS_AS(ctx.feed(std::string_view{"x"}), std::logic_error);
+    CHECK_THROWS_AS(ctx.close_input(), std::logic_error);
+}
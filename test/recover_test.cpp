@@ -15,13 +15,19 @@
 //   - Recovered node is transparent (no tree)
 //   - Both API forms: Rule::set_recovery and peg::recover sugar
 //   - Predicate-based sync via recover_predicate
+//   - Analyzable specs (set / eol / eof) scan in bulk with the same result
+//     as the per-character predicate, over contiguous and paged sources
 // ---------------------------------------------------------------------------
 
 #include "peglib.h"
 
 #include "doctest.h"
 
+#include <cstdio>
+#include <fstream>
+#include <set>
 #include <string>
+#include <vector>
 
 using namespace peg;
 
@@ -82,16 +88,16 @@ TEST_CASE("recover-cut-committed-failure-not-recovered")
 {
     Grammar<> g;
     // 'a' commit 'b' / fallback. Once 'a' matches and cut commits, 'b' MUST
-    // match — the failure escalates to a hard ParseError. Recovery must not
-    // override that commitment.
+    // match — the failure escalates to a committed failure. Recovery must
+    // not override that commitment.
     g["ab"] = (g.terminal('a') >> g.cut() >> g.terminal('b')) | g.terminal('c');
     g["ab"].set_recovery(recover_set<char>({';'}));
 
     std::string input = "ax;"; // 'a' matches, cut commits, 'b' fails on 'x'
     Context ctx(input);
-    // The cut-committed failure throws internally; Grammar::parse catches
-    // ParseError and returns false. Recovery must NOT fire — the input was
-    // committed and a hard error is the correct outcome.
+    // The committed failure propagates out and Grammar::parse returns
+    // false. Recovery must NOT fire — the input was committed and a hard
+    // error is the correct outcome.
     CHECK_FALSE(g.parse("ab", ctx));
     // No diagnostics recorded (recovery did not run).
     CHECK(ctx.diagnostics().empty());
@@ -204,3 +210,103 @@ TEST_CASE("recover-predicate-custom-condition")
     REQUIRE(diags.size() == 1);
     CHECK(diags[0].position() == 0);
 }
+
+// ---------------------------------------------------------------------------
+// Analyzable specs: recover_set / recover_eol / recover_eof carry a kind and
+// a byte bitmap, and the scan runs over whole chunks (memchr, SWAR, bitmap)
+// instead of one predicate call per character. The resume position and the
+// diagnostics must match the equivalent recover_predicate exactly.
+// ---------------------------------------------------------------------------
+namespace
+{
+// Resume positions of a `*stmt` parse where every statement recovers.
+template<typename MakeCtx>
+std::vector<std::size_t> resume_positions(RecoverSpec<char> spec, MakeCtx make_ctx)
+{
+    Grammar<> g;
+    g["stmt"] = g.terminalSeq("ok") >> g.terminal(';');
+    g["stmt"].set_recovery(std::move(spec));
+    g["prog"] = *g["stmt"];
+    auto ctx = make_ctx();
+    REQUIRE(g.parse("prog", ctx));
+    CHECK(ctx.ended());
+    std::vector<std::size_t> out;
+    for (const auto& d : ctx.take_diagnostics()) {
+        out.push_back(d.position());
+    }
+    return out;
+}
+
+// Sync characters at varied offsets, so hits land on every byte of an
+// 8-byte word and in the scalar tail.
+std::string scattered_input()
+{
+    std::string s;
+    const char syncs[] = {';', '}', '\n', '|', '#'};
+    for (std::size_t i = 0; i < 60; ++i) {
+        s.append(i % 19, static_cast<char>('a' + i % 26));
+        s += syncs[i % 5];
+    }
+    s += "trailing";
+    return s;
+}
+} // namespace
+
+TEST_CASE("recover-analyzable-specs-record-their-kind")
+{
+    CHECK(recover_set<char>({';'}).kind == RecoverKind::Set);
+    CHECK(recover_eol<char>().kind == RecoverKind::Eol);
+    CHECK(recover_eof<char>().kind == RecoverKind::Eof);
+    CHECK(recover_predicate<char>([](char) { return true; }).kind == RecoverKind::Predicate);
+
+    auto set = recover_set<char>({';', '}', ';'});
+    CHECK(set.sync_bytes.count == 2);
+    CHECK(set.sync_bytes.test(';'));
+    CHECK(set.sync_bytes.test('}'));
+    CHECK_FALSE(set.sync_bytes.test('{'));
+
+    // High bytes are plain bitmap members.
+    auto high = recover_set<char>({static_cast<char>(0xE9)});
+    CHECK(high.kind == RecoverKind::Set);
+    CHECK(high.sync_bytes.test(0xE9));
+
+    // A wide member that does not fit the bitmap keeps the predicate.
+    CHECK(recover_set<char32_t>({U';'}).kind == RecoverKind::Set);
+    CHECK(recover_set<char32_t>({U';', U'\u2028'}).kind == RecoverKind::Predicate);
+}
+
+TEST_CASE("recover-bulk-scan-matches-predicate")
+{
+    const std::string input = scattered_input();
+    auto in_memory = [&] { return Context<char>{input}; };
+    auto same_as_predicate = [&](RecoverSpec<char> spec, std::set<char> sync) {
+        auto pred = recover_predicate<char>([sync](char c) { return sync.count(c) > 0; });
+        CHECK(resume_positions(std::move(spec), in_memory) == resume_positions(pred, in_memory));
+    };
+    same_as_predicate(recover_set<char>({';'}), {';'});                  // memchr
+    same_as_predicate(recover_set<char>({';', '}'}), {';', '}'});        // SWAR
+    same_as_predicate(recover_set<char>({';', '}', '|', '#'}), {';', '}', '|', '#'});
+    same_as_predicate(recover_set<char>({';', '}', '|', '#', '\n'}),    // bitmap
+                      {';', '}', '|', '#', '\n'});
+    same_as_predicate(recover_eol<char>(), {'\n'});
+    same_as_predicate(recover_eof<char>(), {});
+}
+
+TEST_CASE("recover-bulk-scan-over-paged-source")
+{
+    const std::string input = scattered_input();
+    const std::string path = std::string(PEGLIB_TEST_DATA_DIR) + "/recover_paged.tmp";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(input.data(), static_cast<std::streamsize>(input.size()));
+    }
+    auto in_memory = [&] { return Context<char>{input}; };
+    // 7-item pages: sync characters fall on page boundaries and some scans
+    // cross several pages.
+    auto paged = [&] { return from_paged_file<char>(path, {.page_size = 7, .page_count = 2}); };
+    CHECK(resume_positions(recover_set<char>({';', '}'}), paged) ==
+          resume_positions(recover_set<char>({';', '}'}), in_memory));
+    CHECK(resume_positions(recover_eol<char>(), paged) ==
+          resume_positions(recover_eol<char>(), in_memory));
+    std::remove(path.c_str());
+}
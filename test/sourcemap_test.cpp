@@ -3,6 +3,7 @@
 
 #include "doctest.h"
 
+#include <cstdio>
 #include <fstream>
 #include <string>
 #include <string_view>
@@ -164,3 +165,277 @@ TEST_CASE("sourcemap-filesource-equivalent-to-contiguous")
         CHECK(filed.line_content(line) == contiguous.line_content(line));
     }
 }
+
+TEST_CASE("sourcemap-parallel-prescan-matches-serial")
+{
+    // Lines of varying length, including empty lines and CRLF, so slice
+    // boundaries land both on and next to newlines.
+    std::string text;
+    for (int i = 0; i < 500; ++i) {
+        text.append(static_cast<std::size_t>(i % 13), 'x');
+        text += (i % 5 == 0) ? "\r\n" : "\n";
+    }
+    text += "tail";
+
+    SourceMap serial{std::string_view{text}};
+    for (unsigned threads : {2u, 3u, 7u, 64u}) {
+        SourceMap parallel{std::string_view{text},
+                           SourceMapOptions{.parallel_threshold = 1, .max_threads = threads}};
+        REQUIRE(parallel.num_lines() == serial.num_lines());
+        for (std::size_t line = 1; line <= serial.num_lines(); ++line) {
+            CHECK(parallel.offset_of(line, 1) == serial.offset_of(line, 1));
+        }
+    }
+}
+
+TEST_CASE("sourcemap-paged-and-mapped-sources-equivalent-to-contiguous")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    std::ifstream fs(license_path, std::ios::binary);
+    std::string full{std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>()};
+    SourceMap contiguous{std::string_view{full}};
+
+    // Tiny pages: many page-window chunks, newlines on page boundaries.
+    FileSource<char, 8> tiny{license_path};
+    SourceMap tiny_map{tiny};
+    PagedFileSource<char> paged{license_path, {.page_size = 5, .page_count = 2}};
+    SourceMap paged_map{paged};
+    MmapSource<char> mapped{license_path};
+    SourceMap mapped_map{mapped, SourceMapOptions{.parallel_threshold = 1, .max_threads = 4}};
+
+    for (const SourceMap* map : {&tiny_map, &paged_map, &mapped_map}) {
+        REQUIRE(map->num_lines() == contiguous.num_lines());
+        for (std::size_t line = 1; line <= contiguous.num_lines(); ++line) {
+            CHECK(map->offset_of(line, 1) == contiguous.offset_of(line, 1));
+        }
+    }
+    CHECK(paged_map.line_content(3) == contiguous.line_content(3));
+}
+
+TEST_CASE("sourcemap-lazy-indexes-only-as-far-as-queried")
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "line " + std::to_string(i) + "\n";
+    }
+    SourceMap eager{std::string_view{text}};
+    SourceMap lazy{std::string_view{text}, SourceMapOptions{.lazy = true, .lazy_block = 16}};
+    CHECK(lazy.indexed_bytes() == 0);
+
+    auto loc = lazy.locate(20);
+    CHECK(loc.line == eager.locate(20).line);
+    CHECK(loc.column == eager.locate(20).column);
+    CHECK(lazy.indexed_bytes() < 64);
+
+    CHECK(lazy.offset_of(10, 1) == eager.offset_of(10, 1));
+    CHECK(lazy.line_view(10) == eager.line_view(10));
+    CHECK(lazy.indexed_bytes() < text.size() / 4);
+
+    // Whole-input queries finish the index.
+    CHECK(lazy.num_lines() == eager.num_lines());
+    CHECK(lazy.indexed_bytes() == text.size());
+    CHECK(lazy.offset_of(5000, 1) == SourceMap::npos);
+}
+
+TEST_CASE("sourcemap-lazy-over-filesource")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    FileSource<char, 64> fsource{license_path};
+    SourceMap eager{fsource};
+    SourceMap lazy{fsource, SourceMapOptions{.lazy = true, .lazy_block = 1}};
+    CHECK(lazy.line_content(2) == eager.line_content(2));
+    CHECK(lazy.indexed_bytes() < fsource.size());
+    CHECK(lazy.locate(fsource.size() - 1).line == eager.locate(fsource.size() - 1).line);
+}
+
+TEST_CASE("sourcemap-apply-edit-matches-rescan")
+{
+    struct Edit
+    {
+        std::size_t offset;
+        std::size_t removed;
+        std::string inserted;
+    };
+    const Edit edits[] = {
+        {0, 0, "new first line\n"},   // insert at start
+        {10, 3, ""},                  // delete within a line
+        {5, 20, "x\ny\r\nz"},         // replace across newlines
+        {30, 0, "\n\n\n"},            // blank lines
+        {0, 40, ""},                  // delete a prefix spanning lines
+    };
+
+    for (bool lazy : {false, true}) {
+        std::string text = "alpha\nbeta\r\ngamma\n\ndelta epsilon\nzeta\neta theta iota\n";
+        SourceMap map{std::string_view{text},
+                      SourceMapOptions{.lazy = lazy, .lazy_block = 8}};
+        if (lazy) {
+            (void)map.locate(12); // partially indexed
+        }
+        for (const auto& e : edits) {
+            REQUIRE(e.offset + e.removed <= text.size());
+            map.apply_edit(e.offset, e.removed, e.inserted);
+            text.replace(e.offset, e.removed, e.inserted);
+            map.rebind(text);
+
+            SourceMap fresh{std::string_view{text}};
+            REQUIRE(map.num_lines() == fresh.num_lines());
+            for (std::size_t line = 1; line <= fresh.num_lines(); ++line) {
+                CHECK(map.offset_of(line, 1) == fresh.offset_of(line, 1));
+                CHECK(map.line_view(line) == fresh.line_view(line));
+            }
+            for (std::size_t off = 0; off < text.size(); off += 3) {
+                CHECK(map.locate(off).line == fresh.locate(off).line);
+            }
+        }
+    }
+}
+
+TEST_CASE("sourcemap-compact-index-matches-vector")
+{
+    // Line lengths from 0 to several KB so deltas need 1-, 2- and 3-byte
+    // varints, and enough lines to span many 64-line blocks.
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text.append(static_cast<std::size_t>((i * i) % 3000), 'x');
+        text += '\n';
+    }
+    text += "last";
+
+    SourceMap vec{std::string_view{text}};
+    SourceMap compact{std::string_view{text}, SourceMapOptions{.index = LineIndex::Compact}};
+    REQUIRE(compact.num_lines() == vec.num_lines());
+    for (std::size_t line = 1; line <= vec.num_lines(); ++line) {
+        CHECK(compact.offset_of(line, 1) == vec.offset_of(line, 1));
+    }
+    for (std::size_t off = 0; off < text.size() + 5; off += 97) {
+        CHECK(compact.locate(off).line == vec.locate(off).line);
+        CHECK(compact.locate(off).column == vec.locate(off).column);
+    }
+    CHECK(compact.line_view(500) == vec.line_view(500));
+    CHECK(compact.index_memory_bytes() * 3 < vec.index_memory_bytes());
+}
+
+TEST_CASE("sourcemap-compact-index-over-filesource-and-lazy")
+{
+    const std::string license_path = std::string(PEGLIB_TEST_DATA_DIR) + "/../LICENSE";
+    FileSource<char, 64> fsource{license_path};
+    SourceMap vec{fsource};
+    SourceMap compact{fsource, SourceMapOptions{.index = LineIndex::Compact}};
+    SourceMap lazy_compact{
+        fsource, SourceMapOptions{.lazy = true, .lazy_block = 1, .index = LineIndex::Compact}};
+
+    CHECK(lazy_compact.line_content(100) == vec.line_content(100));
+    REQUIRE(compact.num_lines() == vec.num_lines());
+    for (std::size_t line = 1; line <= vec.num_lines(); ++line) {
+        CHECK(compact.line_content(line) == vec.line_content(line));
+        CHECK(lazy_compact.offset_of(line, 2) == vec.offset_of(line, 2));
+    }
+}
+
+namespace
+{
+// Reference column: decode the line prefix code point by code point.
+std::size_t ref_column(std::string_view text, std::size_t offset, bool utf16)
+{
+    const std::size_t start = text.rfind('\n', offset == 0 ? 0 : offset - 1);
+    std::size_t i = (start == std::string_view::npos || start >= offset) ? 0 : start + 1;
+    std::size_t col = 1;
+    for (; i < offset; ++i) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if ((c & 0xC0) != 0x80) {
+            col += (utf16 && c >= 0xF0) ? 2 : 1;
+        }
+    }
+    return col;
+}
+
+// ASCII lines interleaved with 2-, 3- and 4-byte UTF-8 sequences, CRLF and
+// long ASCII runs (so the 8-byte ASCII test sees whole words).
+std::string mixed_utf8_lines()
+{
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        switch (i % 5) {
+        case 0: text += "plain ascii line " + std::to_string(i); break;
+        case 1: text += "caf\xC3\xA9 na\xC3\xAFve"; break;               // U+00E9, U+00EF
+        case 2: text += "x = \xE2\x86\x92 y;  // arrow"; break;           // U+2192
+        case 3: text += "emoji \xF0\x9F\x98\x80 and \xF0\x9F\x8E\x89!"; break; // 2 astral
+        default: text += std::string(static_cast<std::size_t>(i % 17), 'a') + "\r"; break;
+        }
+        text += '\n';
+    }
+    text += "\xCE\xBB tail"; // non-ASCII last line without a newline
+    return text;
+}
+} // namespace
+
+TEST_CASE("sourcemap-utf16-and-codepoint-columns")
+{
+    SourceMap map{std::string_view{"ab\n\xC3\xA9x\xF0\x9F\x98\x80y\n"}};
+    CHECK(map.is_ascii_line(1));
+    CHECK_FALSE(map.is_ascii_line(2));
+    CHECK(map.is_ascii_line(3)); // empty last line
+
+    // Line 2: U+00E9 (2 bytes), 'x', U+1F600 (4 bytes), 'y'.
+    CHECK(map.locate(6).column == 4);             // bytes
+    CHECK(map.locate_codepoint(6).column == 3);   // e-acute, x
+    CHECK(map.locate_utf16(6).column == 3);
+    CHECK(map.locate_codepoint(10).column == 4);  // after the emoji
+    CHECK(map.locate_utf16(10).column == 5);      // surrogate pair
+    CHECK(map.locate_utf16(1).column == 2);       // ASCII line: byte column
+    CHECK(map.locate_utf16(10).line == 2);
+
+    CHECK(map.locate_utf16(14).column == map.locate(14).column);
+}
+
+TEST_CASE("sourcemap-unit-columns-agree-across-scan-modes")
+{
+    const std::string text = mixed_utf8_lines();
+    SourceMap serial{std::string_view{text}};
+    SourceMap parallel{std::string_view{text},
+                       SourceMapOptions{.parallel_threshold = 1, .max_threads = 7}};
+    SourceMap lazy{std::string_view{text}, SourceMapOptions{.lazy = true, .lazy_block = 5}};
+    SourceMap compact{std::string_view{text}, SourceMapOptions{.index = LineIndex::Compact}};
+
+    const std::string path = std::string(PEGLIB_TEST_DATA_DIR) + "/sourcemap_utf8.tmp";
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+    {
+        FileSource<char, 16> fsource{path};
+        SourceMap filed{fsource};
+
+        for (const SourceMap* map : {&serial, &parallel, &lazy, &compact, &filed}) {
+            const std::size_t last = serial.num_lines();
+            for (std::size_t line = 1; line < last; ++line) {
+                CHECK(map->is_ascii_line(line) == (line % 5 == 1 || line % 5 == 0));
+            }
+            CHECK_FALSE(map->is_ascii_line(last));
+            for (std::size_t off = 0; off <= text.size(); ++off) {
+                CHECK(map->locate_utf16(off).column == ref_column(text, off, true));
+                CHECK(map->locate_codepoint(off).column == ref_column(text, off, false));
+            }
+        }
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("sourcemap-apply-edit-keeps-unit-columns-correct")
+{
+    std::string text = "ascii one\nascii two\nascii three\n";
+    SourceMap map{std::string_view{text}};
+    // Insert a non-ASCII character into line 2, then a new line of ASCII.
+    map.apply_edit(12, 0, "\xE2\x86\x92");
+    text.insert(12, "\xE2\x86\x92");
+    map.apply_edit(0, 0, "new\n");
+    text.insert(0, "new\n");
+    map.rebind(text);
+
+    for (std::size_t off = 0; off <= text.size(); ++off) {
+        CHECK(map.locate_utf16(off).column == ref_column(text, off, true));
+    }
+    // Untouched lines keep their fast path; edited ones are decoded.
+    CHECK(map.is_ascii_line(4));
+    CHECK_FALSE(map.is_ascii_line(3));
+}
@@ -410,3 +410,53 @@ TEST_CASE("typed-action: recovered rule does not invoke the action")
     CHECK(action_runs == 0); // the typed action did NOT run
     CHECK_FALSE(ctx.take_diagnostics().empty());
 }
+
+// ---------------------------------------------------------------------------
+// 16. ParsePhaseStats: the out-parameter overload fills every phase and
+//     returns the same value as the plain overload.
+// ---------------------------------------------------------------------------
+TEST_CASE("typed-action: parse_ast phase stats")
+{
+    Grammar<char, Node> g;
+    g["ws"] = *g.terminal(' ');
+    auto d = (g["d"] = g.token('0', '9'));
+    d.set_action([](Ctx&, Span, char ch) -> Node { return Node{ch - '0'}; });
+    auto sum = (g["sum"] = g["d"] >> *(g.terminal('+') >> g["d"]));
+    sum.set_action([](Ctx&, Span, Node first, std::vector<Node> rest) -> Node {
+        for (const auto& n : rest) {
+            first.value += n.value;
+        }
+        return first;
+    });
+    int hooks = 0;
+    g["d"].on_match([&hooks](Ctx&, const Ctx::ParseTreeNodePtr&) { ++hooks; });
+    g.set_skipper(g["ws"]);
+
+    std::string in = "   1 + 2 + 3";
+    Ctx plain_ctx(in);
+    const auto plain = g.parse_ast("sum", plain_ctx);
+    REQUIRE(plain);
+
+    Ctx ctx(in);
+    ParsePhaseStats stats;
+    stats.fold.ns = 12345; // overwritten
+    const auto ast = g.parse_ast("sum", ctx, stats);
+    REQUIRE(ast);
+    CHECK(ast->value == plain->value);
+    CHECK(ast->value == 6);
+    CHECK(hooks == 6);
+    CHECK(stats.skip.nodes > 0);
+    CHECK(stats.tree.nodes > 0);
+    CHECK(stats.skip.nodes + stats.tree.nodes == ctx.node_count());
+    CHECK(stats.on_match.nodes > 3);
+    CHECK(stats.fold.nodes == stats.on_match.nodes);
+    CHECK(stats.total_ns() ==
+          stats.skip.ns + stats.tree.ns + stats.on_match.ns + stats.fold.ns);
+
+    // A failed parse runs neither walk.
+    std::string bad = " +";
+    Ctx bad_ctx(bad);
+    CHECK_FALSE(g.parse_ast("sum", bad_ctx, stats));
+    CHECK(stats.on_match.ns == 0);
+    CHECK(stats.fold.nodes == 0);
+}